@@ -0,0 +1,368 @@
+/*
+	Headless benchmarks for the pathfinding code, nothing in here needs a window
+
+	Usage: 2D-Pathfinding-Benchmark [benchmark]
+	Runs every benchmark when none is named.
+		cooperative - WHCA* throughput with 10 to 10,000 agents
+		tiled       - tile faults and I/O per query on a streamed world for a few resident set sizes, and how much longer than the shortest paths its paths are
+		parallel    - HDA* speedup over the grid's A* for 1 thread up to the hardware thread count, and whether both find the same paths
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "cooperativePlanner.h"
+#include "grid.h"
+#include "hdaSearch.h"
+#include "neighbourhood.h"
+#include "pathHash.h"
+#include "tiledWorld.h"
+#include "versionedGrid.h"
+
+#pragma region Helpers
+
+// Random map with roughly wallPercent percent of its cells blocked and a blocked border
+static std::vector<unsigned char>
+makeRandomMap(int width, int height, int wallPercent, unsigned int seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> percent(0, 99);
+
+	std::vector<unsigned char> blocked(width * height, 0);
+	for (int y = 0; y < height; y++)
+		for (int x = 0; x < width; x++)
+			if (x == 0 || y == 0 || x == width - 1 || y == height - 1 || percent(rng) < wallPercent)
+				blocked[x + y * width] = 1;
+
+	return blocked;
+}
+
+// Length of a path given as consecutive cells of a width wide map
+static double
+pathLength(const std::vector<long long>& path, long long width)
+{
+	double length = 0;
+	for (size_t i = 1; i < path.size(); i++)
+	{
+		bool diagonal = path[i] % width != path[i - 1] % width && path[i] / width != path[i - 1] / width;
+		length += diagonal ? NEIGHBOUR_DIAGONAL_COST : NEIGHBOUR_STRAIGHT_COST;
+	}
+	return length;
+}
+
+static double
+millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+#pragma endregion
+
+#pragma region Benchmarks
+
+// Plans a few windows for a growing crowd of agents heading for a handful of shared objectives
+static void
+benchmarkCooperative()
+{
+	const int width = 512, height = 512;
+	const int window = 16, rounds = 4, objectives = 16;
+	const int agentCounts[] = { 10, 100, 1000, 10000 };
+
+	std::vector<unsigned char> blocked = makeRandomMap(width, height, 15, 1);
+	std::mt19937 rng(2);
+	std::uniform_int_distribution<int> anyCell(0, width * height - 1);
+
+	std::vector<int> goals;
+	while (int(goals.size()) < objectives)
+	{
+		int cell = anyCell(rng);
+		if (!blocked[cell])
+			goals.push_back(cell);
+	}
+
+	cooperativePlanner planner(blocked.data(), width, height, window, objectives);
+
+	// Builds the heuristic of every objective up front so it isn't counted against the first run
+	std::vector<cooperativeAgent> warmup;
+	for (int goal : goals)
+		warmup.push_back(cooperativeAgent{ goal, goal });
+	planner.planWindow(warmup);
+
+	printf("WHCA* on a %ix%i map, window %i, %i rounds of %i steps\n", width, height, window, rounds, window / 2);
+	printf("%8s %12s %14s %12s %10s %10s %12s %9s\n", "agents", "total ms", "plans/sec", "expansions", "failed", "clashes", "collisions", "arrived");
+
+	for (int agentCount : agentCounts)
+	{
+		// Every agent starts on its own cell
+		std::vector<cooperativeAgent> agents;
+		std::vector<unsigned char> taken(blocked);
+		while (int(agents.size()) < agentCount)
+		{
+			int cell = anyCell(rng);
+			if (taken[cell])
+				continue;
+
+			taken[cell] = 1;
+			agents.push_back(cooperativeAgent{ cell, goals[agents.size() % objectives] });
+		}
+
+		cooperativeStats before = planner.getStats();
+		int arrived = 0;
+
+		auto start = std::chrono::steady_clock::now();
+		for (int r = 0; r < rounds; r++)
+		{
+			planner.planWindow(agents);
+			arrived = planner.step(agents, window / 2);
+		}
+		double ms = millisecondsSince(start);
+
+		const cooperativeStats& after = planner.getStats();
+		unsigned long long plans = after.plans - before.plans;
+		printf("%8i %12.2f %14.0f %12llu %10llu %10llu %12llu %9i\n", agentCount, ms, plans / (ms / 1000.0), after.expansions - before.expansions,
+			after.failedPlans - before.failedPlans, after.reservationClashes - before.reservationClashes, after.collisions - before.collisions, arrived);
+	}
+}
+
+// Writes a streamed world to disk, then runs the same queries with different resident set sizes
+// Corridor paths aren't always the shortest ones, so they are also held against an unrestricted search
+static void
+benchmarkTiled()
+{
+	const long long width = 8192, height = 8192;
+	const long long maxReach = 2048;
+	const int tileSize = 256, queries = 16;
+	const size_t residentSizes[] = { 4, 16, 64, 1024 };
+	const char* path = "benchmark_world";
+
+	// Scattered walls with some open plains and solid lakes, so all three kinds of tile show up
+	auto isBlocked = [](long long x, long long y) {
+		if ((x / 1024 + y / 1024) % 5 == 0)
+			return false;
+		if (x % 2048 > 1700 && y % 2048 > 1700)
+			return true;
+
+		uint64_t h = uint64_t(x) * 0x9E3779B97F4A7C15ull ^ uint64_t(y) * 0xC2B2AE3D27D4EB4Full;
+		h ^= h >> 29;
+		h *= 0xBF58476D1CE4E5B9ull;
+		h ^= h >> 32;
+		return h % 100 < 20;
+	};
+
+	auto start = std::chrono::steady_clock::now();
+	if (!tiledWorld::write(path, width, height, tileSize, isBlocked))
+	{
+		printf("ERROR::Could not write the benchmark world\n");
+		return;
+	}
+	printf("Streamed %lldx%lld world with %ix%i tiles, written in %.0f ms\n", width, height, tileSize, tileSize, millisecondsSince(start));
+
+	// Goals are kept within a couple of thousand cells of the start, like a unit being sent across part of the map
+	std::mt19937_64 rng(3);
+	std::uniform_int_distribution<long long> anyX(0, width - 1), anyY(0, height - 1), offset(-maxReach, maxReach);
+	std::vector<std::pair<long long, long long>> pairs;
+	while (int(pairs.size()) < queries)
+	{
+		long long ax = anyX(rng), ay = anyY(rng);
+		long long bx = ax + offset(rng), by = ay + offset(rng);
+		if (bx < 0 || by < 0 || bx >= width || by >= height || isBlocked(ax, ay) || isBlocked(bx, by))
+			continue;
+
+		pairs.push_back(std::make_pair(ax + ay * width, bx + by * width));
+	}
+
+	// The shortest paths, searched once with room for every tile
+	std::vector<double> shortest;
+	{
+		tiledWorld world(path, size_t(-1));
+		if (!world.isOpen())
+			return;
+
+		std::vector<long long> route;
+		for (const auto& q : pairs)
+			shortest.push_back(world.findShortestPath(q.first, q.second, route, size_t(-1)) ? pathLength(route, width) : -1);
+	}
+
+	printf("%10s %12s %14s %16s %14s %16s %12s %8s %12s\n", "resident", "ms/query", "faults/query", "io bytes/query", "corridor", "expanded/query", "found",
+		"longer", "worst excess");
+	for (size_t residentSize : residentSizes)
+	{
+		tiledWorld world(path, residentSize);
+		if (!world.isOpen())
+			return;
+
+		int found = 0;
+		std::vector<double> lengths;
+		std::vector<long long> route;
+		start = std::chrono::steady_clock::now();
+		for (const auto& q : pairs)
+		{
+			bool hasPath = world.findPath(q.first, q.second, route);
+			found += hasPath;
+			lengths.push_back(hasPath ? pathLength(route, width) : -1);
+		}
+		double ms = millisecondsSince(start);
+
+		// Measured outside the timed loop, the lengths differ by rounding alone when both paths are the shortest
+		int longer = 0;
+		double worstExcess = 0;
+		for (int q = 0; q < queries; q++)
+		{
+			if (lengths[q] < 0 || shortest[q] <= 0)
+				continue;
+
+			double excess = (lengths[q] - shortest[q]) / shortest[q];
+			if (excess > 1e-9)
+			{
+				longer++;
+				worstExcess = std::max(worstExcess, excess);
+			}
+		}
+
+		const tiledQueryStats& totals = world.getTotalStats();
+		printf("%10zu %12.2f %14.1f %16.0f %14.1f %16.0f %9i/%i %8i %11.2f%%\n", residentSize, ms / queries, double(totals.tileFaults) / queries,
+			double(totals.ioBytes) / queries, double(totals.corridorTiles) / queries, double(totals.expansions) / queries, found, queries,
+			longer, worstExcess * 100);
+	}
+
+	std::remove((std::string(path) + ".index").c_str());
+	std::remove((std::string(path) + ".tiles").c_str());
+}
+
+// Runs the same queries through the grid's A* and through HDA* with more and more threads, on the same snapshot of the grid
+// Every query has to come back from HDA* as the very path the grid found, the grid's size ( ONE_AXIS_CELLS ) sets how long
+// the queries get
+static void
+benchmarkParallel()
+{
+	const int queries = 500, runs = 3;
+
+	grid* g = new grid();
+	g->printResults = false;
+	g->InitCells();
+
+	std::mt19937 rng(4);
+	std::uniform_int_distribution<int> percent(0, 99), inside(1, ONE_AXIS_CELLS - 2);
+	for (int y = 1; y < ONE_AXIS_CELLS - 1; y++)
+		for (int x = 1; x < ONE_AXIS_CELLS - 1; x++)
+			if (percent(rng) < 30)
+				g->setCellType(g->getCellDiscrete(x, y), BOUNDARY);
+
+	// Start and goal are two different free cells
+	std::vector<std::pair<int, int>> pairs;
+	while (int(pairs.size()) < queries)
+	{
+		cell* start = g->getCellDiscrete(inside(rng), inside(rng));
+		cell* goal = g->getCellDiscrete(inside(rng), inside(rng));
+		if (start != goal && start->type != BOUNDARY && goal->type != BOUNDARY)
+			pairs.push_back(std::make_pair(start->getArrayPos(), goal->getArrayPos()));
+	}
+
+	// The grid's answers are what every thread count is held against
+	std::vector<float> gridCosts(queries);
+	std::vector<uint64_t> gridHashes(queries);
+	double gridMilliseconds = 0;
+	for (int run = 0; run < runs; run++)
+	{
+		double ms = 0;
+		for (int q = 0; q < queries; q++)
+		{
+			g->setStart(&g->cells[pairs[q].first]);
+			g->setGoal(&g->cells[pairs[q].second]);
+
+			auto timer = std::chrono::steady_clock::now();
+			g->searchWith<eightConnected, TIE_BREAKING>();
+			ms += millisecondsSince(timer);
+
+			gridCosts[q] = g->hasPath() ? g->getPathCost() : -1;
+			gridHashes[q] = g->getPathHash();
+		}
+
+		if (run == 0 || ms < gridMilliseconds)
+			gridMilliseconds = ms;
+	}
+
+	std::vector<unsigned int> threadCounts;
+	unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned int t = 1; t < hardwareThreads; t *= 2)
+		threadCounts.push_back(t);
+	threadCounts.push_back(hardwareThreads);
+
+	// HDA* reads the snapshot the grid's searches read, through a reader slot of its own
+	int reader = g->snapshots.acquireReader();
+	const gridVersion* version = g->snapshots.pin(reader);
+
+	printf("HDA* against the grid's A* on a %ix%i grid, %i queries, best of %i runs\n", ONE_AXIS_CELLS, ONE_AXIS_CELLS, queries, runs);
+	printf("%8s %12s %10s %14s %14s %12s\n", "threads", "ms", "speedup", "expansions", "messages", "mismatched");
+	printf("%8s %12.2f %9.2fx %14s %14s %12s\n", "grid A*", gridMilliseconds, 1.0, "-", "-", "-");
+
+	for (unsigned int threadCount : threadCounts)
+	{
+		hdaSearch search(ONE_AXIS_CELLS, ONE_AXIS_CELLS, threadCount);
+		std::vector<int> path;
+
+		double best = 0;
+		int mismatched = 0;
+		unsigned long long expansions = 0, messages = 0;
+		for (int run = 0; run < runs; run++)
+		{
+			double ms = 0;
+			mismatched = 0;
+			expansions = 0;
+			messages = 0;
+			for (int q = 0; q < queries; q++)
+			{
+				auto timer = std::chrono::steady_clock::now();
+				float cost = search.findPath<eightConnected>(version, pairs[q].first, pairs[q].second, path);
+				ms += millisecondsSince(timer);
+
+				expansions += search.getStats().expansions;
+				messages += search.getStats().messages;
+
+				// Same cost to the last bit and the same cells in the same order
+				uint64_t hash = hashPath(path.data(), int(path.size()));
+				if (cost != gridCosts[q] || hash != gridHashes[q])
+				{
+					if (run == 0)
+						printf("ERROR::%u threads found a path costing %f ( hash %016llx ) from %i to %i, the grid found %f ( hash %016llx )\n",
+							threadCount, cost, (unsigned long long)hash, pairs[q].first, pairs[q].second, gridCosts[q], (unsigned long long)gridHashes[q]);
+					mismatched++;
+				}
+			}
+
+			if (run == 0 || ms < best)
+				best = ms;
+		}
+
+		printf("%8u %12.2f %9.2fx %14llu %14llu %12i\n", threadCount, best, gridMilliseconds / best, expansions, messages, mismatched);
+	}
+
+	g->snapshots.unpin(reader);
+	g->snapshots.releaseReader(reader);
+	delete g;
+}
+
+#pragma endregion
+
+int
+main(int argc, char* argv[])
+{
+	const char* which = argc > 1 ? argv[1] : nullptr;
+
+	if (which == nullptr || strcmp(which, "cooperative") == 0)
+		benchmarkCooperative();
+
+	if (which == nullptr || strcmp(which, "tiled") == 0)
+		benchmarkTiled();
+
+	if (which == nullptr || strcmp(which, "parallel") == 0)
+		benchmarkParallel();
+
+	return 0;
+}
@@ -0,0 +1,151 @@
+/*
+	Headless check of the vectorized distance field against an exact Dijkstra
+
+	Usage: 2D-Pathfinding-DistanceFieldCheck [maps] [seed]
+
+	The sweeps in distanceField only stop once nothing changes, so a wrong relaxation ( a missed row, a lane of the SSE loads
+	past the end of a row ) shows up as a distance that is too large rather than as a crash. This computes fields on random
+	maps of every size from one cell up, from open fields to mazes, and checks every cell against a Dijkstra that counts
+	straight and diagonal steps as integers, so its distances are exact. Runs 500 maps from seed 1 when nothing is given.
+
+	A field is summed in floats, so a distance may be off by the rounding of the additions that made it ( at most one float
+	epsilon of the distance per step ), anything more counts as a mismatch. So does a cell only one side can reach.
+
+	Exits with 0 when every cell matched and 2 when at least one didn't.
+*/
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "distanceField.h"
+#include "neighbourhood.h"
+
+// Largest width and height of a map, sizes are picked at random up to these
+#define MAX_MAP_SIZE 160
+
+// Exact distance of every cell from source, or -1 for cells it can't reach, moves are 8-connected like the field's
+static std::vector<double>
+exactDistances(const std::vector<unsigned char>& blocked, int width, int height, int source)
+{
+	// A distance is straight + diagonal * sqrt(2), kept as the two counts so no rounding builds up along a path
+	struct steps {
+		long long straight, diagonal;
+		double length() const { return double(straight) + double(diagonal) * std::sqrt(2.0); }
+	};
+
+	std::vector<double> distances(blocked.size(), -1);
+	if (blocked[source])
+		return distances;
+
+	std::vector<steps> best(blocked.size(), steps{ -1, -1 });
+	std::vector<bool> settled(blocked.size(), false);
+
+	typedef std::pair<double, int> entry;
+	std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+	best[source] = steps{ 0, 0 };
+	open.push(entry(0.0, source));
+
+	while (!open.empty())
+	{
+		int cell = open.top().second;
+		open.pop();
+		if (settled[cell])
+			continue;
+		settled[cell] = true;
+		distances[cell] = best[cell].length();
+
+		for (int i = 0; i < 8; i++)
+		{
+			int nx = cell % width + neighbourDx[i];
+			int ny = cell / width + neighbourDy[i];
+			if (nx < 0 || ny < 0 || nx >= width || ny >= height)
+				continue;
+
+			int next = nx + ny * width;
+			if (blocked[next] || settled[next])
+				continue;
+
+			steps s = best[cell];
+			if (neighbourDx[i] != 0 && neighbourDy[i] != 0)
+				s.diagonal++;
+			else
+				s.straight++;
+
+			if (best[next].straight < 0 || s.length() < best[next].length())
+			{
+				best[next] = s;
+				open.push(entry(s.length(), next));
+			}
+		}
+	}
+
+	return distances;
+}
+
+int
+main(int argc, char* argv[])
+{
+	int maps = argc > 1 ? atoi(argv[1]) : 500;
+	unsigned int seed = argc > 2 ? unsigned(atoi(argv[2])) : 1;
+
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> percent(0, 99), size(1, MAX_MAP_SIZE);
+
+	int mismatchedMaps = 0;
+	long long cells = 0, mismatchedCells = 0;
+	double worstError = 0;
+	for (int m = 0; m < maps; m++)
+	{
+		int width = size(rng), height = size(rng);
+
+		// From open fields up to maps where the source reaches next to nothing
+		int wallPercent = percent(rng) % 50;
+		std::vector<unsigned char> blocked(width * height);
+		for (unsigned char& b : blocked)
+			b = percent(rng) < wallPercent;
+
+		// Now and then the source is a wall, the field then has to reach nothing at all
+		int source = std::uniform_int_distribution<int>(0, width * height - 1)(rng);
+		if (percent(rng) >= 5)
+			blocked[source] = 0;
+
+		distanceField field(width, height);
+		field.compute(blocked.data(), source);
+		std::vector<double> expected = exactDistances(blocked, width, height, source);
+
+		int mismatched = 0;
+		for (int i = 0; i < width * height; i++)
+		{
+			float distance = field.getDistance(i);
+			bool reached = distance != distanceField::UNREACHABLE;
+
+			bool match = reached == (expected[i] >= 0);
+			if (match && reached)
+			{
+				double error = std::fabs(double(distance) - expected[i]);
+				worstError = std::max(worstError, error);
+				match = error <= expected[i] * expected[i] * FLT_EPSILON + FLT_EPSILON;
+			}
+
+			if (!match && mismatched++ == 0)
+				printf("Map %i ( %ix%i, %i%% walls, source %i ): cell %i has distance %.8f, Dijkstra gives %.8f\n", m, width, height,
+					wallPercent, source, i, reached ? distance : -1.f, expected[i]);
+		}
+
+		cells += width * height;
+		mismatchedCells += mismatched;
+		if (mismatched > 0)
+			mismatchedMaps++;
+	}
+
+	printf("Checked %lld cells on %i maps: %lld cells mismatched on %i maps, largest difference %.8f\n", cells, maps,
+		mismatchedCells, mismatchedMaps, worstError);
+	return mismatchedMaps > 0 ? 2 : 0;
+}
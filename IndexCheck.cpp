@@ -0,0 +1,208 @@
+/*
+	Headless check of the grid's dense node index against the lookups it replaced
+
+	Usage: 2D-Pathfinding-IndexCheck [maps] [seed]
+
+	Before nodeIndex the search found out whether a cell already had a node, and which one, by scanning every node it
+	had discovered ( checkVisited and fetchNode ). This runs queries on random maps through the grid's search and through
+	a copy of it that still does those scans, for every neighbourhood, and checks that both give the same path, cost and
+	path hash. Runs 200 maps from seed 1 when nothing is given.
+
+	Exits with 0 when every query matched and 2 when at least one didn't.
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "grid.h"
+
+// Queries run on every map, for each neighbourhood
+#define QUERIES_PER_MAP 10
+
+// Returns true if a node for cell has been discovered, scanning every node like the grid used to
+static bool
+checkVisited(const std::vector<node*>& d, int cell)
+{
+	for (node* n : d)
+		if (n->c->getArrayPos() == cell)
+			return true;
+	return false;
+}
+
+// Returns the node of cell, or NULL if it hasn't been discovered
+static node*
+fetchNode(const std::vector<node*>& d, int cell)
+{
+	for (node* n : d)
+		if (n->c->getArrayPos() == cell)
+			return n;
+	return NULL;
+}
+
+// The grid's A* step for step, only the node lookups are the old linear scans
+// Fills path goal first without the start, like the grid, and returns the cost or -1 if there is no path
+template <typename Neighbourhood, typename TieBreak>
+static float
+referenceSearch(grid* g, std::vector<int>& path)
+{
+	int start = g->startPosition;
+	int goal = g->goalPosition;
+	auto heuristic = [&](int c) {
+		return Neighbourhood::heuristic(g->cells[start].arrayX - g->cells[c].arrayX, g->cells[start].arrayY - g->cells[c].arrayY);
+	};
+
+	// Reads the same snapshot the grid's search does, through a reader slot of its own
+	int reader = g->snapshots.acquireReader();
+	const gridVersion* map = g->snapshots.pin(reader);
+
+	std::vector<node*> discovery;
+	discovery.push_back(new node(0, heuristic(goal), heuristic(goal), &g->cells[goal], NULL));
+
+	node* startNode = NULL;
+	while (1)
+	{
+		node* n = NULL;
+		for (node* candidate : discovery)
+			if (!candidate->visited && (n == NULL || TieBreak::better(candidate->fCost, candidate->gCost, candidate->c->getArrayPos(), n->fCost, n->gCost, n->c->getArrayPos())))
+				n = candidate;
+
+		if (n == NULL)
+			break;
+		if (startNode != NULL && n->fCost > startNode->gCost + PATH_TIE_EPSILON)
+			break;
+
+		n->visited = true;
+		if (n->c->getArrayPos() == start)
+		{
+			startNode = n;
+			continue;
+		}
+
+		unsigned int moves = Neighbourhood::allowedMoves(map->neighbourMask(n->c->arrayX, n->c->arrayY));
+		Neighbourhood::forEachMove(moves, [&](int i, float stepCost) {
+			int cell = n->c->getArrayPos() + neighbourDx[i] + neighbourDy[i] * ONE_AXIS_CELLS;
+			int back = 7 - i;
+			float gCost = n->gCost + stepCost;
+
+			if (!checkVisited(discovery, cell))
+			{
+				float hCost = heuristic(cell);
+				node* m = new node(gCost, hCost, gCost + hCost, &g->cells[cell], n);
+				m->parentDirection = back;
+				discovery.push_back(m);
+				return;
+			}
+
+			node* m = fetchNode(discovery, cell);
+			if (gCost < m->gCost)
+			{
+				m->gCost = gCost;
+				m->fCost = gCost + m->hCost;
+				m->parent = n;
+				m->parentDirection = back;
+				m->visited = false;
+			}
+			else if (gCost == m->gCost && back < m->parentDirection)
+			{
+				m->parent = n;
+				m->parentDirection = back;
+			}
+		});
+	}
+
+	path.clear();
+	float cost = -1;
+	if (startNode != NULL)
+	{
+		cost = startNode->gCost;
+		for (node* pathNode = startNode->parent; pathNode != NULL; pathNode = pathNode->parent)
+			path.push_back(pathNode->c->getArrayPos());
+		std::reverse(path.begin(), path.end());
+	}
+
+	for (node* n : discovery)
+		delete n;
+
+	g->snapshots.unpin(reader);
+	g->snapshots.releaseReader(reader);
+	return cost;
+}
+
+// Runs the current query through both searches, prints and returns false when they disagree
+template <typename Neighbourhood>
+static bool
+checkQuery(grid* g, const char* name, int map, int query)
+{
+	g->searchWith<Neighbourhood, TIE_BREAKING>();
+	float cost = g->hasPath() ? g->getPathCost() : -1;
+
+	std::vector<int> expected;
+	float expectedCost = referenceSearch<Neighbourhood, TIE_BREAKING>(g, expected);
+	uint64_t expectedHash = hashPath(expected.data(), int(expected.size()));
+
+	bool samePath = int(expected.size()) == g->getPathLength() && std::equal(expected.begin(), expected.end(), g->getPath());
+	if (samePath && memcmp(&cost, &expectedCost, sizeof(float)) == 0 && expectedHash == g->getPathHash())
+		return true;
+
+	printf("Map %i query %i %s: cost %.8f hash %016llx, linear scan cost %.8f hash %016llx\n", map, query, name, cost,
+		(unsigned long long)g->getPathHash(), expectedCost, (unsigned long long)expectedHash);
+	return false;
+}
+
+int
+main(int argc, char* argv[])
+{
+	int maps = argc > 1 ? atoi(argv[1]) : 200;
+	unsigned int seed = argc > 2 ? unsigned(atoi(argv[2])) : 1;
+
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> percent(0, 99), inside(1, ONE_AXIS_CELLS - 2);
+
+	int queries = 0, found = 0, mismatched = 0;
+	for (int m = 0; m < maps; m++)
+	{
+		grid* g = new grid();
+		g->InitCells();
+		g->printResults = false;
+
+		// From open fields up to maps where most queries have no path
+		int wallPercent = percent(rng) % 45;
+		for (int y = 1; y < ONE_AXIS_CELLS - 1; y++)
+			for (int x = 1; x < ONE_AXIS_CELLS - 1; x++)
+				if (percent(rng) < wallPercent)
+					g->setCellType(g->getCellDiscrete(x, y), BOUNDARY);
+
+		for (int q = 0; q < QUERIES_PER_MAP; q++)
+		{
+			cell* start;
+			cell* goal;
+			do
+			{
+				start = g->getCellDiscrete(inside(rng), inside(rng));
+				goal = g->getCellDiscrete(inside(rng), inside(rng));
+			} while (start == goal || start->type == BOUNDARY || goal->type == BOUNDARY);
+
+			g->resetPath();
+			g->setStart(start);
+			g->setGoal(goal);
+
+			bool match = checkQuery<fourConnected>(g, "fourConnected", m, q);
+			match &= checkQuery<eightConnected>(g, "eightConnected", m, q);
+			found += g->hasPath();
+			match &= checkQuery<eightConnectedNoCornerCutting>(g, "eightConnectedNoCornerCutting", m, q);
+
+			queries++;
+			if (!match)
+				mismatched++;
+		}
+
+		delete g;
+	}
+
+	printf("Checked %i queries on %i maps with every neighbourhood: %i mismatched, %i had an 8-connected path\n", queries, maps, mismatched, found);
+	return mismatched > 0 ? 2 : 0;
+}
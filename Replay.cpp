@@ -0,0 +1,166 @@
+/*
+	Headless replay of scenario files through the grid's pathfinding, nothing in here needs a window
+
+	Usage: 2D-Pathfinding-Replay <map> <scenario> [results]
+
+	Loads the map ( see mapFile.h for the formats ) and runs the queries of the scenario one at a time as they are read,
+	writing one tab separated line per query to results, or to the console when no results file is named. Every line
+	holds the query, the expected and found cost, whether they match, how long the query took and the hash of the path.
+	Maps and scenarios saved from the viewer with M can be replayed as they are.
+
+	Lines of the scenario that can't be read get a row of their own and the replay carries on with the next line.
+
+	The goal bounding boxes of the map are built before the first query and the time it took is reported on its own. Queries
+	that built a shortest-path tree for their goal are left out of the average and slowest search times and are reported on
+	a line of their own, their rows still show the whole time they took.
+
+	Exits with 0 when every query matched, 2 when at least one didn't ( or a line couldn't be read or run ) and 1 when the
+	files couldn't be used.
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#include "grid.h"
+#include "mapFile.h"
+
+// How far a found cost may be from the expected one, scenario files only store a handful of decimals
+#define COST_TOLERANCE 0.0001
+
+// Returns why a query can't be run on the grid, or nullptr when it can
+static const char*
+checkQuery(grid* g, const scenarioQuery& q)
+{
+	int size = ONE_AXIS_CELLS - 2;
+	if (q.startX < 0 || q.startY < 0 || q.startX >= size || q.startY >= size)
+		return "start-outside";
+	if (q.goalX < 0 || q.goalY < 0 || q.goalX >= size || q.goalY >= size)
+		return "goal-outside";
+	if (g->getCellDiscrete(q.startX + 1, q.startY + 1)->type == BOUNDARY)
+		return "start-blocked";
+	if (g->getCellDiscrete(q.goalX + 1, q.goalY + 1)->type == BOUNDARY)
+		return "goal-blocked";
+	if (q.startX == q.goalX && q.startY == q.goalY)
+		return "start-is-goal";
+
+	return nullptr;
+}
+
+int
+main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		printf("Usage: 2D-Pathfinding-Replay <map> <scenario> [results]\n");
+		return 1;
+	}
+
+	grid* g = new grid();
+	g->InitCells();
+	g->printResults = false;
+
+	if (!g->loadMap(argv[1]))
+	{
+		delete g;
+		return 1;
+	}
+
+	// Building the boxes takes far longer than a search, it would otherwise land on the first query
+	auto boundsStart = std::chrono::steady_clock::now();
+	g->buildGoalBounds();
+	double boundsMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - boundsStart).count();
+
+	scenarioReader reader(argv[2]);
+	if (!reader.isOpen())
+	{
+		delete g;
+		return 1;
+	}
+
+	FILE* results = stdout;
+	if (argc > 3)
+	{
+		results = fopen(argv[3], "w");
+		if (results == nullptr)
+		{
+			printf("ERROR::Results file %s could not be created\n", argv[3]);
+			delete g;
+			return 1;
+		}
+	}
+
+	fprintf(results, "query\tstartX\tstartY\tgoalX\tgoalY\texpected\tcost\tresult\tmicroseconds\thash\n");
+
+	int queries = 0, matched = 0, mismatched = 0, invalid = 0, unreadable = 0;
+	int treeQueries = 0;
+	double totalMicroseconds = 0, slowestMicroseconds = 0, treeMicroseconds = 0;
+
+	scenarioQuery q;
+	SCENARIO_LINE read;
+	while ((read = reader.next(q)) != SCENARIO_END)
+	{
+		if (read == SCENARIO_UNREADABLE)
+		{
+			fprintf(results, "%i\t-\t-\t-\t-\t-\t-\tunreadable-line-%i\t-\t-\n", queries++, reader.getLine());
+			unreadable++;
+			continue;
+		}
+
+		const char* problem = checkQuery(g, q);
+		if (problem != nullptr)
+		{
+			fprintf(results, "%i\t%i\t%i\t%i\t%i\t%.8f\t-\t%s\t-\t-\n", queries++, q.startX, q.startY, q.goalX, q.goalY, q.expectedCost, problem);
+			invalid++;
+			continue;
+		}
+
+		g->resetPath();
+		g->setStart(g->getCellDiscrete(q.startX + 1, q.startY + 1));
+		g->setGoal(g->getCellDiscrete(q.goalX + 1, q.goalY + 1));
+
+		unsigned long long treesBuilt = g->trees.getStats().built;
+		auto start = std::chrono::steady_clock::now();
+		g->pathfindGrid();
+		double microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+		double cost = g->hasPath() ? g->getPathCost() : -1;
+		bool match = q.expectedCost < 0 ? !g->hasPath() : g->hasPath() && std::fabs(cost - q.expectedCost) <= COST_TOLERANCE;
+
+		fprintf(results, "%i\t%i\t%i\t%i\t%i\t%.8f\t%.8f\t%s\t%.2f\t%016llx\n", queries++, q.startX, q.startY, q.goalX, q.goalY,
+			q.expectedCost, cost, match ? "match" : "mismatch", microseconds, (unsigned long long)g->getPathHash());
+
+		// Results are written as we go, so a replay that dies halfway still leaves everything up to that point
+		fflush(results);
+
+		if (match)
+			matched++;
+		else
+			mismatched++;
+
+		if (g->trees.getStats().built > treesBuilt)
+		{
+			treeQueries++;
+			treeMicroseconds += microseconds;
+			continue;
+		}
+
+		totalMicroseconds += microseconds;
+		slowestMicroseconds = std::max(slowestMicroseconds, microseconds);
+	}
+
+	int searched = matched + mismatched - treeQueries;
+	printf("Replayed %i queries: %i matched, %i mismatched, %i could not be run, %i could not be read\n", queries, matched, mismatched, invalid, unreadable);
+	if (g->goalBounding)
+		printf("Goal bounds built in %.2f ms\n", boundsMilliseconds);
+	if (treeQueries > 0)
+		printf("%i queries built a path tree, %.2f us per query on average\n", treeQueries, treeMicroseconds / treeQueries);
+	if (searched > 0)
+		printf("%.2f us per query on average, slowest %.2f us\n", totalMicroseconds / searched, slowestMicroseconds);
+
+	if (results != stdout)
+		fclose(results);
+
+	delete g;
+	return mismatched > 0 || invalid > 0 || unreadable > 0 ? 2 : 0;
+}
@@ -0,0 +1,321 @@
+#include "cooperativePlanner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+#include "neighbourhood.h"
+
+// Waiting costs as much as a straight step, except on the goal where staying is free
+#define WAIT_COST 1.f
+
+static uint32_t
+hashCell(int cell)
+{
+	return uint32_t(cell) * 0x9E3779B1u;
+}
+
+cooperativePlanner::cooperativePlanner(const unsigned char* blocked, int width, int height, int windowDepth, size_t maxGoalFields)
+	: width{ width }, height{ height }, windowDepth{ windowDepth }, passability{ width, height }, blocked(blocked, blocked + width * height),
+	cellBlocks{ width * height }, maxGoalFields{ maxGoalFields }
+{
+	for (int i = 0; i < width * height; i++)
+		if (blocked[i])
+			passability.setBlocked(i % width, i / width, true);
+
+	occupied.assign(width * height, 0);
+}
+
+void
+cooperativePlanner::planWindow(const std::vector<cooperativeAgent>& agents)
+{
+	// A new round makes every old reservation stale at once
+	round++;
+
+	// Keep every table at most half full, every agent holds one cell per timestep
+	int needed = 16;
+	while (needed < int(agents.size()) * 2)
+		needed *= 2;
+	if (needed > tableSize)
+	{
+		tableSize = needed;
+		reservations.assign(size_t(tableSize) * (windowDepth + 1), reservation{ -1, -1, 0 });
+	}
+
+	plans.assign(agents.size() * (windowDepth + 1), -1);
+
+	// Everyone's current cell is taken at time 0, which is what stops two agents from swapping places
+	for (size_t i = 0; i < agents.size(); i++)
+		reserve(agents[i].position, 0, int(i));
+
+	for (size_t i = 0; i < agents.size(); i++)
+	{
+		stats.plans++;
+		if (!planAgent(int(i), agents[i]))
+		{
+			stats.failedPlans++;
+			std::fill(plans.begin() + i * (windowDepth + 1), plans.begin() + (i + 1) * (windowDepth + 1), agents[i].position);
+		}
+
+		const int* plan = getPlan(int(i));
+		for (int t = 1; t <= windowDepth; t++)
+			reserve(plan[t], t, int(i));
+	}
+}
+
+int
+cooperativePlanner::step(std::vector<cooperativeAgent>& agents, int steps)
+{
+	steps = std::min(steps, windowDepth);
+	occupiedStamp++;
+
+	int arrived = 0;
+	for (size_t i = 0; i < agents.size(); i++)
+	{
+		agents[i].position = getPlan(int(i))[steps];
+
+		if (occupied[agents[i].position] == occupiedStamp)
+			stats.collisions++;
+		occupied[agents[i].position] = occupiedStamp;
+
+		if (agents[i].position == agents[i].goal)
+			arrived++;
+	}
+
+	return arrived;
+}
+
+const int*
+cooperativePlanner::getPlan(int agent) const
+{
+	return &plans[size_t(agent) * (windowDepth + 1)];
+}
+
+int
+cooperativePlanner::getWindowDepth() const
+{
+	return windowDepth;
+}
+
+const cooperativeStats&
+cooperativePlanner::getStats() const
+{
+	return stats;
+}
+
+bool
+cooperativePlanner::planAgent(int agent, const cooperativeAgent& a)
+{
+	struct openEntry {
+		float fCost;
+		float gCost;
+		int node;
+
+		// Lowest f first, deeper nodes first on ties
+		bool operator<(const openEntry& o) const
+		{
+			if (fCost != o.fCost)
+				return fCost > o.fCost;
+			return gCost < o.gCost;
+		}
+	};
+
+	cellBlocks.clear();
+	timeNodes.clear();
+	nodes.clear();
+
+	std::priority_queue<openEntry> open;
+	nodes.push_back(searchNode{ a.position, 0, 0.f, -1 });
+	insertNode(a.position, 0, 0);
+	open.push(openEntry{ heuristic(a.position, a.goal), 0.f, 0 });
+
+	int found = -1;
+	while (!open.empty())
+	{
+		openEntry e = open.top();
+		open.pop();
+
+		searchNode n = nodes[e.node];
+		if (e.gCost > n.gCost)
+			continue;
+
+		// Either the window is used up or we can sit on the goal for the rest of it
+		if (n.time == windowDepth)
+		{
+			found = e.node;
+			break;
+		}
+
+		if (n.cell == a.goal)
+		{
+			bool free = true;
+			for (int t = n.time + 1; t <= windowDepth && free; t++)
+			{
+				int holder = reservedBy(n.cell, t);
+				free = holder == -1 || holder == agent;
+			}
+
+			if (free)
+			{
+				found = e.node;
+				break;
+			}
+		}
+
+		stats.expansions++;
+
+		int x = n.cell % width;
+		int y = n.cell / width;
+		int t = n.time + 1;
+
+		// Bits 0 to 7 are the moves, bit 8 is waiting in place
+		unsigned int moves = passability.neighbourMask(x, y) | (1u << 8);
+		while (moves)
+		{
+			int i = bitCountTrailingZeros(moves);
+			moves &= moves - 1;
+
+			int next = n.cell;
+			float cost = n.cell == a.goal ? 0.f : WAIT_COST;
+			if (i < 8)
+			{
+				next = n.cell + neighbourDx[i] + neighbourDy[i] * width;
+				cost = neighbourStepCost(i);
+			}
+
+			int holder = reservedBy(next, t);
+			if (holder != -1 && holder != agent)
+				continue;
+
+			// Whoever is on next right now can't be moving onto our cell at the same time
+			if (next != n.cell)
+			{
+				int other = reservedBy(next, n.time);
+				if (other != -1 && other != agent && reservedBy(n.cell, t) == other)
+					continue;
+			}
+
+			float gCost = n.gCost + cost;
+			int existing = findNode(next, t);
+			if (existing != -1 && nodes[existing].gCost <= gCost)
+				continue;
+
+			if (existing == -1)
+			{
+				existing = int(nodes.size());
+				nodes.push_back(searchNode{ next, t, gCost, e.node });
+				insertNode(next, t, existing);
+			}
+			else
+			{
+				nodes[existing].gCost = gCost;
+				nodes[existing].parent = e.node;
+			}
+
+			open.push(openEntry{ gCost + heuristic(next, a.goal), gCost, existing });
+		}
+	}
+
+	if (found == -1)
+		return false;
+
+	// Walk back to the start, then hold the last cell for whatever is left of the window
+	int* plan = &plans[size_t(agent) * (windowDepth + 1)];
+	int last = nodes[found].time;
+	std::fill(plan + last, plan + windowDepth + 1, nodes[found].cell);
+	for (int n = found; n != -1; n = nodes[n].parent)
+		plan[nodes[n].time] = nodes[n].cell;
+
+	return true;
+}
+
+float
+cooperativePlanner::heuristic(int cell, int goal)
+{
+	auto found = goalFields.find(goal);
+	if (found == goalFields.end() && goalFields.size() < maxGoalFields)
+	{
+		std::unique_ptr<distanceField> field(new distanceField(width, height));
+		field->compute(blocked.data(), goal);
+		found = goalFields.emplace(goal, std::move(field)).first;
+	}
+
+	if (found != goalFields.end())
+	{
+		// Cells that can't reach the goal still need a finite value so the window can be planned
+		float d = found->second->getDistance(cell);
+		if (d != distanceField::UNREACHABLE)
+			return d;
+	}
+
+	int dx = std::abs(cell % width - goal % width);
+	int dy = std::abs(cell / width - goal / width);
+	return std::max(dx, dy) + (NEIGHBOUR_DIAGONAL_COST - NEIGHBOUR_STRAIGHT_COST) * std::min(dx, dy);
+}
+
+void
+cooperativePlanner::reserve(int cell, int time, int agent)
+{
+	reservation* table = &reservations[size_t(time % (windowDepth + 1)) * tableSize];
+	uint32_t mask = uint32_t(tableSize - 1);
+
+	for (uint32_t slot = hashCell(cell) & mask;; slot = (slot + 1) & mask)
+	{
+		reservation& r = table[slot];
+		if (r.round != round)
+		{
+			r.cell = cell;
+			r.agent = agent;
+			r.round = round;
+			return;
+		}
+
+		// Only an agent that failed to plan can get here, replacing the holder would hide the earlier plan from everyone after us
+		if (r.cell == cell)
+		{
+			if (r.agent != agent)
+				stats.reservationClashes++;
+			return;
+		}
+	}
+}
+
+int
+cooperativePlanner::reservedBy(int cell, int time) const
+{
+	if (time > windowDepth)
+		return -1;
+
+	const reservation* table = &reservations[size_t(time % (windowDepth + 1)) * tableSize];
+	uint32_t mask = uint32_t(tableSize - 1);
+
+	for (uint32_t slot = hashCell(cell) & mask;; slot = (slot + 1) & mask)
+	{
+		const reservation& r = table[slot];
+		if (r.round != round)
+			return -1;
+		if (r.cell == cell)
+			return r.agent;
+	}
+}
+
+int
+cooperativePlanner::findNode(int cell, int time)
+{
+	int block = cellBlocks.find(cell);
+	return block < 0 ? -1 : timeNodes[size_t(block) * (windowDepth + 1) + time];
+}
+
+void
+cooperativePlanner::insertNode(int cell, int time, int node)
+{
+	int block = cellBlocks.find(cell);
+	if (block < 0)
+	{
+		block = int(timeNodes.size() / (windowDepth + 1));
+		cellBlocks.insert(cell, block);
+		timeNodes.resize(timeNodes.size() + windowDepth + 1, -1);
+	}
+
+	timeNodes[size_t(block) * (windowDepth + 1) + time] = node;
+}
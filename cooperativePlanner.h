@@ -0,0 +1,123 @@
+#pragma once
+
+/*
+	Windowed Hierarchical Cooperative A* ( WHCA* )
+
+	Planning every agent on its own makes their paths run into each other in corridors. Here agents are planned one
+	after the other in ( cell, time ) space, and each finished plan is written into a shared reservation table which the
+	agents planned after it have to respect, so they wait or go around instead of colliding. Planning only looks
+	windowDepth steps ahead, beyond that the remaining distance to the goal is estimated by the heuristic, which is the
+	true distance from a distance field where one is available and octile distance otherwise.
+
+	The usual way to run this is to plan a window for everyone, execute part of it and plan the next window.
+
+	The reservation table is a ring of windowDepth + 1 open addressing hash tables, one per timestep, keyed by cell.
+	Entries are stamped with the planning round they belong to, so starting a new window doesn't have to clear anything.
+*/
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "distanceField.h"
+#include "nodeIndex.h"
+#include "passabilityBitmap.h"
+
+struct cooperativeAgent {
+	int position;
+	int goal;
+};
+
+struct cooperativeStats {
+	unsigned long long plans = 0;
+	unsigned long long expansions = 0;
+
+	// Agents that found no way through the reservations and had to stay where they were
+	unsigned long long failedPlans = 0;
+
+	// Times two agents ended up on the same cell after a step
+	unsigned long long collisions = 0;
+
+	// Times an agent that had to stay put was left on a cell an earlier agent had already reserved
+	unsigned long long reservationClashes = 0;
+};
+
+class cooperativePlanner {
+/// Variables
+private:
+	struct reservation {
+		int cell;
+		int agent;
+		uint32_t round;
+	};
+
+	struct searchNode {
+		int cell;
+		int time;
+		float gCost;
+		int parent;
+	};
+
+	int width, height;
+	int windowDepth;
+	passabilityBitmap passability;
+	std::vector<unsigned char> blocked;
+
+	// Reservation ring, windowDepth + 1 tables of tableSize entries each
+	std::vector<reservation> reservations;
+	int tableSize = 0;
+	uint32_t round = 0;
+
+	// Per search space-time index, ( cell, time ) -> node. Every cell the search reaches gets a block of windowDepth + 1
+	// entries in timeNodes, one per timestep, and cellBlocks says which block is the cell's
+	nodeIndex cellBlocks;
+	std::vector<int> timeNodes;
+	std::vector<searchNode> nodes;
+
+	// windowDepth + 1 cells per agent, the first one being where the agent is now
+	std::vector<int> plans;
+
+	// True distance heuristics for the first maxGoalFields goals we come across
+	size_t maxGoalFields;
+	std::unordered_map<int, std::unique_ptr<distanceField>> goalFields;
+
+	// Scratch space used to spot collisions after a step
+	std::vector<uint32_t> occupied;
+	uint32_t occupiedStamp = 0;
+
+	cooperativeStats stats;
+
+/// Functions & Methods
+public:
+	// Constructor, blocked holds width * height bytes with a non-zero byte for every impassable cell
+	cooperativePlanner(const unsigned char* blocked, int width, int height, int windowDepth, size_t maxGoalFields);
+
+	// Plans the next window for every agent, earlier agents in the vector have priority over later ones
+	void planWindow(const std::vector<cooperativeAgent>& agents);
+
+	// Moves every agent steps cells along its plan ( at most windowDepth ) and returns how many are at their goal
+	int step(std::vector<cooperativeAgent>& agents, int steps);
+
+	// Returns the windowDepth + 1 planned cells of an agent
+	const int* getPlan(int agent) const;
+
+	// Getters
+	int getWindowDepth() const;
+	const cooperativeStats& getStats() const;
+
+private:
+	// Plans one agent against the current reservations and writes its plan, returns false if it had to stay put
+	bool planAgent(int agent, const cooperativeAgent& a);
+
+	float heuristic(int cell, int goal);
+
+	// The first agent to reserve a cell at a time keeps it, a later one asking for it is counted as a clash
+	void reserve(int cell, int time, int agent);
+
+	// Returns the agent holding cell at time, or -1
+	int reservedBy(int cell, int time) const;
+
+	int findNode(int cell, int time);
+	void insertNode(int cell, int time, int node);
+};
@@ -0,0 +1,279 @@
+#include "distanceField.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+#include "neighbourhood.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DISTANCE_FIELD_SSE 1
+#include <emmintrin.h>
+#else
+#define DISTANCE_FIELD_SSE 0
+#endif
+
+const float distanceField::UNREACHABLE = std::numeric_limits<float>::infinity();
+
+distanceField::distanceField(int width, int height) : width{ width }, height{ height }, stride{ width + 2 }
+{
+	distances.assign(stride * height, UNREACHABLE);
+	walls.assign(stride * height, UNREACHABLE);
+}
+
+int
+distanceField::compute(const unsigned char* blocked, int source)
+{
+	reset(blocked, source);
+
+	sweepCount = 0;
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+
+		// Downward sweep
+		for (int y = 0; y < height; y++)
+			changed |= relaxRow(y, -1);
+
+		// Upward sweep
+		for (int y = height - 1; y >= 0; y--)
+			changed |= relaxRow(y, 1);
+
+		sweepCount += 2;
+	}
+
+	return sweepCount;
+}
+
+void
+distanceField::computeReference(const unsigned char* blocked, int source)
+{
+	reset(blocked, source);
+
+	// Same as compute, a blocked source reaches nothing
+	if (blocked[source])
+		return;
+
+	typedef std::pair<float, int> entry;
+	std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+	open.push(entry(0.f, source));
+
+	while (!open.empty())
+	{
+		entry e = open.top();
+		open.pop();
+
+		int x = e.second % width;
+		int y = e.second / width;
+		if (e.first > distances[paddedIndex(e.second)])
+			continue;
+
+		for (int dy = -1; dy <= 1; dy++)
+			for (int dx = -1; dx <= 1; dx++)
+			{
+				int nx = x + dx;
+				int ny = y + dy;
+				if ((dx == 0 && dy == 0) || nx < 0 || ny < 0 || nx >= width || ny >= height)
+					continue;
+
+				int neighbour = nx + ny * width;
+				if (blocked[neighbour])
+					continue;
+
+				float d = e.first + (dx != 0 && dy != 0 ? NEIGHBOUR_DIAGONAL_COST : NEIGHBOUR_STRAIGHT_COST);
+				if (d < distances[paddedIndex(neighbour)])
+				{
+					distances[paddedIndex(neighbour)] = d;
+					open.push(entry(d, neighbour));
+				}
+			}
+	}
+}
+
+float
+distanceField::validate(const unsigned char* blocked, int source)
+{
+	computeReference(blocked, source);
+	std::vector<float> reference = distances;
+
+	compute(blocked, source);
+
+	float maxError = 0;
+	for (int i = 0; i < width * height; i++)
+	{
+		float a = reference[paddedIndex(i)];
+		float b = distances[paddedIndex(i)];
+
+		// Both unreachable counts as a match, only one of them being unreachable is as wrong as it gets
+		if (a == UNREACHABLE || b == UNREACHABLE)
+		{
+			if (a != b)
+				return UNREACHABLE;
+			continue;
+		}
+
+		maxError = std::max(maxError, std::fabs(a - b));
+	}
+
+	return maxError;
+}
+
+float
+distanceField::getDistance(int index) const
+{
+	return distances[paddedIndex(index)];
+}
+
+int
+distanceField::getWidth() const
+{
+	return width;
+}
+
+int
+distanceField::getHeight() const
+{
+	return height;
+}
+
+int
+distanceField::getSweepCount() const
+{
+	return sweepCount;
+}
+
+void
+distanceField::reset(const unsigned char* blocked, int source)
+{
+	std::fill(distances.begin(), distances.end(), UNREACHABLE);
+
+	for (int y = 0; y < height; y++)
+		for (int x = 0; x < width; x++)
+			walls[y * stride + x + 1] = blocked[x + y * width] ? UNREACHABLE : 0.f;
+
+	if (!blocked[source])
+		distances[paddedIndex(source)] = 0;
+
+	rowVersion.assign(height, 1);
+	seenAbove.assign(height, 0);
+	seenBelow.assign(height, 0);
+	seenAlong.assign(height, 0);
+}
+
+bool
+distanceField::relaxRow(int y, int dir)
+{
+	// Rows are only revisited when the row they read from changed since the last visit,
+	// once most of the field has settled this skips nearly all the work of a sweep
+	int neighbour = y + dir;
+	bool changed = false;
+	if (neighbour >= 0 && neighbour < height)
+	{
+		std::vector<int>& seen = dir < 0 ? seenAbove : seenBelow;
+		if (seen[y] != rowVersion[neighbour])
+		{
+			seen[y] = rowVersion[neighbour];
+			if (relaxFromRow(y, dir))
+			{
+				rowVersion[y]++;
+				changed = true;
+			}
+		}
+	}
+
+	if (seenAlong[y] != rowVersion[y])
+	{
+		if (relaxAlongRow(y))
+		{
+			rowVersion[y]++;
+			changed = true;
+		}
+		seenAlong[y] = rowVersion[y];
+	}
+
+	return changed;
+}
+
+bool
+distanceField::relaxFromRow(int y, int dir)
+{
+	float* row = &distances[y * stride + 1];
+	const float* from = &distances[(y + dir) * stride + 1];
+	const float* wall = &walls[y * stride + 1];
+
+	int x = 0;
+	bool changed = false;
+
+#if DISTANCE_FIELD_SSE
+	const __m128 straight = _mm_set1_ps(NEIGHBOUR_STRAIGHT_COST);
+	const __m128 diagonal = _mm_set1_ps(NEIGHBOUR_DIAGONAL_COST);
+	int changedMask = 0;
+
+	for (; x + 4 <= width; x += 4)
+	{
+		__m128 current = _mm_loadu_ps(row + x);
+		__m128 vertical = _mm_add_ps(_mm_loadu_ps(from + x), straight);
+		__m128 diagonals = _mm_add_ps(_mm_min_ps(_mm_loadu_ps(from + x - 1), _mm_loadu_ps(from + x + 1)), diagonal);
+
+		__m128 relaxed = _mm_max_ps(_mm_min_ps(current, _mm_min_ps(vertical, diagonals)), _mm_loadu_ps(wall + x));
+		changedMask |= _mm_movemask_ps(_mm_cmplt_ps(relaxed, current));
+		_mm_storeu_ps(row + x, relaxed);
+	}
+
+	changed = changedMask != 0;
+#endif
+
+	// Whatever is left over ( or everything, without SSE ) is done one cell at a time
+	for (; x < width; x++)
+	{
+		float candidate = std::min(from[x] + NEIGHBOUR_STRAIGHT_COST, std::min(from[x - 1], from[x + 1]) + NEIGHBOUR_DIAGONAL_COST);
+		float relaxed = std::max(std::min(row[x], candidate), wall[x]);
+		if (relaxed < row[x])
+		{
+			row[x] = relaxed;
+			changed = true;
+		}
+	}
+
+	return changed;
+}
+
+bool
+distanceField::relaxAlongRow(int y)
+{
+	float* row = &distances[y * stride + 1];
+	const float* wall = &walls[y * stride + 1];
+
+	// Every cell depends on the one we just wrote, so this part stays scalar
+	bool changed = false;
+	for (int x = 1; x < width; x++)
+	{
+		float relaxed = std::max(std::min(row[x], row[x - 1] + NEIGHBOUR_STRAIGHT_COST), wall[x]);
+		if (relaxed < row[x])
+		{
+			row[x] = relaxed;
+			changed = true;
+		}
+	}
+
+	for (int x = width - 2; x >= 0; x--)
+	{
+		float relaxed = std::max(std::min(row[x], row[x + 1] + NEIGHBOUR_STRAIGHT_COST), wall[x]);
+		if (relaxed < row[x])
+		{
+			row[x] = relaxed;
+			changed = true;
+		}
+	}
+
+	return changed;
+}
+
+int
+distanceField::paddedIndex(int index) const
+{
+	return (index / width) * stride + index % width + 1;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+/*
+	Dense all-cells distance transform
+
+	Computes the shortest distance from one source cell to every cell of a grid in one go, which is what
+	heuristic tables, flow fields and reachability queries all boil down to. Instead of a priority queue
+	the field is relaxed with alternating downward and upward row sweeps ( fast-sweeping / chamfer style )
+	until nothing changes, at which point every edge constraint holds and the distances are exact.
+
+	The vertical and diagonal relaxations only read the previous row, so they run 4 cells at a time with SSE.
+	Movement is 8-connected with a cost of 1 for straight steps and sqrt(2) for diagonal steps ( octile ),
+	the same costs the A* search uses.
+*/
+
+#include <vector>
+
+class distanceField {
+/// Variables
+public:
+	static const float UNREACHABLE;
+
+private:
+	int width, height;
+
+	// Rows are padded with one unreachable cell on each side so the diagonal loads never need bounds checks
+	int stride;
+
+	std::vector<float> distances;
+
+	// 0 for passable cells, UNREACHABLE for blocked cells, so max(distance, wall) pins blocked cells
+	std::vector<float> walls;
+
+	// Every row counts its changes, and remembers the count of the rows it was last relaxed against
+	std::vector<int> rowVersion;
+	std::vector<int> seenAbove;
+	std::vector<int> seenBelow;
+	std::vector<int> seenAlong;
+
+	int sweepCount = 0;
+
+/// Functions & Methods
+public:
+	// Constructor
+	distanceField(int width, int height);
+
+	// Computes the distance from source to every cell using the vectorized sweeps
+	// blocked holds width * height bytes, a non-zero byte marks an impassable cell
+	// Returns the number of sweeps it took to converge
+	int compute(const unsigned char* blocked, int source);
+
+	// Computes the same field with a plain scalar Dijkstra, this is the reference the sweeps are checked against
+	void computeReference(const unsigned char* blocked, int source);
+
+	// Runs both computations and returns the largest absolute difference between them
+	float validate(const unsigned char* blocked, int source);
+
+	// Getters
+	float getDistance(int index) const;
+	int getWidth() const;
+	int getHeight() const;
+	int getSweepCount() const;
+
+private:
+	void reset(const unsigned char* blocked, int source);
+
+	// Brings row y up to date with row y + dir and with itself, skipping whatever can't have changed
+	bool relaxRow(int y, int dir);
+
+	// Relaxes row y against the already finished row y + dir ( dir = -1 going down, 1 going up )
+	bool relaxFromRow(int y, int dir);
+
+	// Relaxes row y against itself, left to right then right to left
+	bool relaxAlongRow(int y);
+
+	int paddedIndex(int index) const;
+};
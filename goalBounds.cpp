@@ -0,0 +1,169 @@
+#include "goalBounds.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <thread>
+
+#include "neighbourhood.h"
+#include "passabilityBitmap.h"
+
+goalBounds::goalBounds(int width, int height) : width{ width }, height{ height }
+{
+}
+
+template <typename Neighbourhood>
+void
+goalBounds::build(const unsigned char* blocked, unsigned int threadCount)
+{
+	boxes.assign(size_t(width) * height * 8, boundingBox{ UINT16_MAX, UINT16_MAX, 0, 0 });
+
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	// Threads take the next source off a shared counter until every cell has been done
+	std::atomic<int> nextSource(0);
+	auto work = [&]() {
+		std::vector<float> distances;
+		std::vector<uint8_t> firstSteps;
+		std::vector<int> order;
+
+		for (int source = nextSource++; source < width * height; source = nextSource++)
+			if (!blocked[source])
+				buildFrom<Neighbourhood>(source, blocked, distances, firstSteps, order);
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int i = 1; i < threadCount; i++)
+		threads.emplace_back(work);
+	work();
+
+	for (std::thread& t : threads)
+		t.join();
+
+	built = true;
+}
+
+void
+goalBounds::clear()
+{
+	boxes.clear();
+	boxes.shrink_to_fit();
+	built = false;
+}
+
+unsigned int
+goalBounds::directionsToward(int cell, int goal) const
+{
+	int goalX = goal % width;
+	int goalY = goal / width;
+
+	const boundingBox* box = &boxes[size_t(cell) * 8];
+	unsigned int mask = 0;
+	for (int i = 0; i < 8; i++)
+		mask |= unsigned(goalX >= box[i].minX && goalX <= box[i].maxX && goalY >= box[i].minY && goalY <= box[i].maxY) << i;
+
+	return mask;
+}
+
+void
+goalBounds::setMapVersion(unsigned long long version)
+{
+	mapVersion = version;
+}
+
+bool
+goalBounds::isBuilt() const
+{
+	return built;
+}
+
+size_t
+goalBounds::getMemoryUsed() const
+{
+	return boxes.capacity() * sizeof(boundingBox);
+}
+
+unsigned long long
+goalBounds::getMapVersion() const
+{
+	return mapVersion;
+}
+
+template <typename Neighbourhood>
+void
+goalBounds::buildFrom(int source, const unsigned char* blocked, std::vector<float>& distances, std::vector<uint8_t>& firstSteps, std::vector<int>& order)
+{
+	typedef std::pair<float, int> entry;
+	std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+
+	distances.assign(size_t(width) * height, std::numeric_limits<float>::infinity());
+	firstSteps.assign(size_t(width) * height, 0);
+	order.clear();
+
+	distances[source] = 0;
+	open.push(entry(0.f, source));
+
+	auto isBlocked = [&](int x, int y) {
+		return x < 0 || y < 0 || x >= width || y >= height || blocked[x + y * width];
+	};
+
+	while (!open.empty())
+	{
+		entry e = open.top();
+		open.pop();
+
+		int cell = e.second;
+		if (e.first > distances[cell])
+			continue;
+		order.push_back(cell);
+
+		int x = cell % width;
+		int y = cell / width;
+
+		unsigned int passable = 0;
+		for (int i = 0; i < 8; i++)
+			passable |= unsigned(!isBlocked(x + neighbourDx[i], y + neighbourDy[i])) << i;
+
+		Neighbourhood::forEachNeighbour(passable, [&](int i, float stepCost) {
+			int next = cell + neighbourDx[i] + neighbourDy[i] * width;
+			float d = e.first + stepCost;
+
+			// Leaving the source, the step itself is the first step
+			uint8_t steps = cell == source ? uint8_t(1 << i) : firstSteps[cell];
+
+			if (d < distances[next] - PATH_TIE_EPSILON)
+			{
+				distances[next] = d;
+				firstSteps[next] = steps;
+				open.push(entry(d, next));
+			}
+			else if (d <= distances[next] + PATH_TIE_EPSILON)
+				firstSteps[next] |= steps;
+		});
+	}
+
+	// Every cell is settled by now, so its first steps are final
+	boundingBox* box = &boxes[size_t(source) * 8];
+	for (int cell : order)
+	{
+		uint16_t x = uint16_t(cell % width);
+		uint16_t y = uint16_t(cell / width);
+
+		for (unsigned int steps = firstSteps[cell]; steps; steps &= steps - 1)
+		{
+			boundingBox& b = box[bitCountTrailingZeros(steps)];
+			b.minX = std::min(b.minX, x);
+			b.minY = std::min(b.minY, y);
+			b.maxX = std::max(b.maxX, x);
+			b.maxY = std::max(b.maxY, y);
+		}
+	}
+}
+
+// The searches only ever use these
+template void goalBounds::build<fourConnected>(const unsigned char*, unsigned int);
+template void goalBounds::build<eightConnected>(const unsigned char*, unsigned int);
+template void goalBounds::build<eightConnectedNoCornerCutting>(const unsigned char*, unsigned int);
@@ -0,0 +1,71 @@
+#pragma once
+
+/*
+	Goal bounding
+
+	For every cell and every direction out of it, keeps the bounding box of all cells whose shortest path from that cell
+	starts with a step in that direction. A search heading for a goal outside of a box can skip that step entirely, since
+	it can't be the start of a shortest route to the goal. On open maps this prunes most of the neighbours of a cell.
+
+	Building the boxes takes one Dijkstra from every passable cell, so it is meant for maps that don't change often.
+	Every source only writes its own boxes, so the Dijkstras are split between threads without any locking.
+
+	When a target can be reached optimally through more than one first step it is added to the box of each of them,
+	which keeps the pruning safe whichever of the equal paths a search happens to prefer.
+
+	Boxes are four 16-bit coordinates ( 8 bytes ), 64 bytes per cell, and directions are in the neighbour mask order
+	NW, N, NE, W, E, SW, S, SE used by passabilityBitmap and neighbourhood.h.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class goalBounds {
+/// Variables
+private:
+	struct boundingBox {
+		uint16_t minX, minY;
+		uint16_t maxX, maxY;
+	};
+
+	int width, height;
+
+	// 8 boxes per cell, a box with min above max holds nothing
+	std::vector<boundingBox> boxes;
+
+	bool built = false;
+
+	// Whoever builds the boxes can tag them with the version of the map they were built from
+	unsigned long long mapVersion = 0;
+
+/// Functions & Methods
+public:
+	// Constructor, width and height may be at most 65535
+	goalBounds(int width, int height);
+
+	// Builds the boxes of every cell, blocked holds width * height bytes with a non-zero byte for every impassable cell
+	// Neighbourhood is one of the policies in neighbourhood.h and has to match the search the boxes are used by
+	// threadCount of 0 uses one thread per hardware thread
+	template <typename Neighbourhood>
+	void build(const unsigned char* blocked, unsigned int threadCount);
+
+	// Drops the boxes, call this whenever the map changes
+	void clear();
+
+	// Returns a mask with bit i set when a step in direction i from cell can still be on a shortest path to goal
+	unsigned int directionsToward(int cell, int goal) const;
+
+	// Setters
+	void setMapVersion(unsigned long long version);
+
+	// Getters
+	bool isBuilt() const;
+	size_t getMemoryUsed() const;
+	unsigned long long getMapVersion() const;
+
+private:
+	// Runs one Dijkstra from source and grows its 8 boxes, the vectors are scratch space owned by the calling thread
+	template <typename Neighbourhood>
+	void buildFrom(int source, const unsigned char* blocked, std::vector<float>& distances, std::vector<uint8_t>& firstSteps, std::vector<int>& order);
+};
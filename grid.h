@@ -0,0 +1,773 @@
+#pragma once
+
+/*
+	The grid and its pathfinding
+
+	Everything the searches need lives in here and nothing in here needs SDL, so the viewer, the replay tool and
+	anything else headless can share the same grid. Drawing it is left to whoever shows it.
+*/
+
+#pragma region Pre-processor Definitions
+
+// Keep these square
+#define WINDOW_WIDTH 400
+#define WINDOW_HEIGHT 400
+
+// This is used for the number of cells on one axis
+// +2 is used to account for the boundary cells
+#define ONE_AXIS_CELLS (20 + 2)
+#define TOTAL_CELLS ONE_AXIS_CELLS * ONE_AXIS_CELLS
+#define CELL_OFFSET WINDOW_WIDTH/(ONE_AXIS_CELLS-2)
+
+#define CELL_BUFFER (CELL_OFFSET/10)
+
+#define DEFAULT_COST 1
+
+#define DRAW_VISITED_NODES 0
+
+// Which cells the search may step to, one of fourConnected, eightConnected or eightConnectedNoCornerCutting ( see neighbourhood.h )
+#define NEIGHBOURHOOD eightConnected
+
+// Which open node is expanded when several share the lowest f cost, preferDeeperNodes or firstDiscovered ( see tieBreaking.h )
+#define TIE_BREAKING preferDeeperNodes
+
+// Memory the path cache may use before it starts dropping the least recently used paths ( in bytes )
+#define PATH_CACHE_BUDGET (64 * 1024)
+
+// Memory the retained shortest-path trees may use ( in bytes ), and how often a goal has to be asked for before it gets a tree
+#define PATH_TREE_BUDGET (16 * 1024)
+#define PATH_TREE_HOT_QUERIES 3
+
+// Number of threads that can hold a snapshot of the grid at once, the grid's own searches take one of the slots
+#define SNAPSHOT_READERS 4
+
+// Prunes steps that can't start a shortest path to the goal, using boxes built for the whole map
+// Building takes one Dijkstra per cell split over GOAL_BOUNDING_THREADS threads ( 0 for one per hardware thread ), which
+// only pays off on maps that stay the same for many queries. So the boxes are only used on a map that was loaded with
+// loadMap and hasn't been edited since, the first edit turns them off until the next map is loaded
+#define GOAL_BOUNDING 1
+#define GOAL_BOUNDING_THREADS 0
+
+// Checks the vectorized distance field against a scalar Dijkstra from the goal every time a path is made
+#define VALIDATE_DISTANCE_FIELD 0
+
+#pragma endregion
+
+#pragma region Includes
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "distanceField.h"
+#include "goalBounds.h"
+#include "mapFile.h"
+#include "neighbourhood.h"
+#include "nodeIndex.h"
+#include "pathHash.h"
+#include "pathCache.h"
+#include "pathTreeCache.h"
+#include "tieBreaking.h"
+#include "versionedGrid.h"
+
+#pragma endregion
+
+#pragma region Enums
+
+// Enum to define all possible states of a cell
+typedef enum {
+	EMPTY,
+	BOUNDARY,
+	PATH,
+	DISCOVERED,
+	START,
+	GOAL
+} CELL_TYPE;
+
+// Enum to define the different ways a path can be searched for, cached paths are kept apart per mode
+typedef enum {
+	ASTAR_SEARCH
+} SEARCH_MODE;
+
+#pragma endregion
+
+#pragma region Structs
+
+//// Cell struct ////
+
+// Cells are physically represented on the screen
+// Cells persist and a fixed number are created on program initialization equal to ONE_AXIS_CELLS^2
+typedef struct {
+	int arrayX = -1;
+	int arrayY = -1;
+	int screenX = -1 * CELL_OFFSET/2;
+	int screenY = -1 * CELL_OFFSET/2;
+	int type = EMPTY;
+	int cost = DEFAULT_COST;
+
+	int getArrayPos()
+	{
+ 		return arrayX + arrayY * ONE_AXIS_CELLS;
+	}
+} cell;
+
+//// Node struct ////
+
+// Nodes are created as needed by the A* pathfinding algorithm and contain pointers to their represented cells
+// This allows us to clear memory after we find a path
+struct node {
+
+	node(float gCost, float hCost, float fCost, cell* c, node* parent) : gCost{ gCost }, hCost{ hCost }, fCost{ fCost }, c{ c }, parent{ parent }
+	{}
+
+	float gCost = 0;
+	float hCost = 0;
+	float fCost = 0;
+	bool visited = 0;
+	node* parent = NULL;
+	cell* c = NULL;
+
+	// Direction of the step from this node to its parent, in adj order
+	int parentDirection = 8;
+};
+
+//// Grid struct ////
+// The core purpose of this project is mostly contained in this struct
+// The grid represents the discritized world space via cells and allows us to place start 
+// and goal locations as well as obstacles to be traversed when we call our pathfinding algorithm
+struct grid{
+	cell cells[TOTAL_CELLS];
+
+	// Tells us if the goal exists and where in the cells array it is located
+	bool goalExist = 0;
+	int goalPosition = 0;
+
+	// Tells us if the start exists and where in the cells array it is located
+	bool startExist = 0;
+	int startPosition = 0;
+
+	// Finished searches, cells that change passability evict the paths that depended on them
+	pathCache cache{ PATH_CACHE_BUDGET, ONE_AXIS_CELLS, ONE_AXIS_CELLS };
+
+	// Shortest-path trees of frequently requested goals, these answer any start without a search
+	pathTreeCache trees{ PATH_TREE_BUDGET, PATH_TREE_HOT_QUERIES, ONE_AXIS_CELLS, ONE_AXIS_CELLS };
+
+	// Copy-on-write versions of which cells are BOUNDARY, searches pin one so edits made while they run don't affect them
+	// This is the only copy of the passability, cell types should only be changed through setCellType so it stays in sync
+	versionedGrid snapshots{ ONE_AXIS_CELLS, ONE_AXIS_CELLS, SNAPSHOT_READERS };
+
+	// Reader slot of the grid's own searches, any other thread that pins snapshots takes a slot of its own
+	int snapshotReader = snapshots.acquireReader();
+
+	// Per cell and direction boxes of the cells a step can lead to optimally, built from a snapshot by the first search that
+	// pins it. Searches hold on to the boxes of their snapshot, so an edit only drops the grid's reference to them
+	std::shared_ptr<const goalBounds> bounds;
+
+	// Whether searches prune with the boxes, true from loadMap until the next edit ( see GOAL_BOUNDING )
+	bool goalBounding = false;
+
+	// Print what every query did, headless tools that report on their own turn this off
+	bool printResults = true;
+
+	// Grid deconstructor ( since we use a static array we only need to hand back the reader slot )
+	~grid()
+	{
+		snapshots.releaseReader(snapshotReader);
+	}
+
+	// Populate the cells array with their starting information
+	// This is where we assign cells their screen position, array position ( via X, Y-coordinates ), and boundary cells their type
+	void 
+	InitCells()
+	{
+		for (int i = 0; i < ONE_AXIS_CELLS; i++)
+			for (int j = 0; j < ONE_AXIS_CELLS; j++)
+			{
+				int cellPos = i + (j * ONE_AXIS_CELLS);
+				if (i == ONE_AXIS_CELLS - 1 || j == ONE_AXIS_CELLS -1 || i == 0 || j == 0)
+				{
+					cells[cellPos].screenY += j * CELL_OFFSET;
+					cells[cellPos].screenX += i * CELL_OFFSET;
+					cells[cellPos].arrayY = j;
+					cells[cellPos].arrayX = i;
+					setCellType(&cells[cellPos], BOUNDARY);
+				}
+				else
+				{
+					cells[cellPos].screenY += j * CELL_OFFSET;
+					cells[cellPos].screenX += i * CELL_OFFSET;
+					cells[cellPos].arrayY = j;
+					cells[cellPos].arrayX = i;
+				}
+
+			}
+	}
+
+	// Changes the type of a cell and publishes a new snapshot when its passability changed
+	void
+	setCellType(cell* c, int type)
+	{
+		bool blocked = type == BOUNDARY;
+		if (blocked != snapshots.isBlocked(c->arrayX, c->arrayY))
+		{
+			// Pruned searches depend on boxes built from the whole map, so the first edit after loading one may have changed
+			// every cached result. Later edits only affect the results crossing the edited cell
+			if (goalBounding)
+			{
+				goalBounding = false;
+				cache.invalidateAll();
+				std::atomic_store(&bounds, std::shared_ptr<const goalBounds>());
+			}
+			else
+				cache.invalidateCell(c->getArrayPos());
+			trees.clear();
+
+			snapshots.setBlocked(c->arrayX, c->arrayY, blocked);
+			snapshots.publish();
+		}
+
+		c->type = type;
+	}
+
+	// Moves the start to c, the cell that held it is emptied ( and if c held the goal, the goal is removed )
+	void
+	setStart(cell* c)
+	{
+		if (startExist)
+			setCellType(&cells[startPosition], EMPTY);
+
+		if (goalExist && c->getArrayPos() == goalPosition)
+			goalExist = 0;
+
+		setCellType(c, START);
+		startPosition = c->getArrayPos();
+		startExist = 1;
+	}
+
+	// Moves the goal to c, the cell that held it is emptied ( and if c held the start, the start is removed )
+	void
+	setGoal(cell* c)
+	{
+		if (goalExist)
+			setCellType(&cells[goalPosition], EMPTY);
+
+		if (startExist && c->getArrayPos() == startPosition)
+			startExist = 0;
+
+		setCellType(c, GOAL);
+		goalPosition = c->getArrayPos();
+		goalExist = 1;
+	}
+
+	// Replaces the walls with those of a map file ( see mapFile.h ), the start and goal are removed
+	// The map has to be as large as the grid without its boundary, since the grid size is fixed at compile time
+	bool
+	loadMap(const std::string& mapPath)
+	{
+		int width, height;
+		std::vector<unsigned char> blocked;
+		if (!readMapFile(mapPath, width, height, blocked))
+			return false;
+
+		if (width != ONE_AXIS_CELLS - 2 || height != ONE_AXIS_CELLS - 2)
+		{
+			printf("ERROR::Map %s is %ix%i but the grid holds %ix%i cells\n", mapPath.c_str(), width, height, ONE_AXIS_CELLS - 2, ONE_AXIS_CELLS - 2);
+			return false;
+		}
+
+		resetPath();
+		startExist = 0;
+		goalExist = 0;
+
+		for (int y = 0; y < height; y++)
+			for (int x = 0; x < width; x++)
+				setCellType(getCellDiscrete(x + 1, y + 1), blocked[x + y * width] ? BOUNDARY : EMPTY);
+
+#if GOAL_BOUNDING
+		goalBounding = true;
+#endif
+		return true;
+	}
+
+	// Writes the walls to a map file, the boundary cells aren't part of it
+	bool
+	saveMap(const std::string& mapPath)
+	{
+		int width = ONE_AXIS_CELLS - 2, height = ONE_AXIS_CELLS - 2;
+		std::vector<unsigned char> blocked(width * height);
+		for (int y = 0; y < height; y++)
+			for (int x = 0; x < width; x++)
+				blocked[x + y * width] = getCellDiscrete(x + 1, y + 1)->type == BOUNDARY;
+
+		return writeMapFile(mapPath, width, height, blocked);
+	}
+
+	// Retrieves a cell from their screen position
+	// This is primarily used for retrieving a cell when the mouse is clicked
+	cell*
+	getCellFromScreenPosition(int x, int y)
+	{
+		// We need to add 1 to the cell's discrete value to compensate for the boundary cells off-screen
+		int xOffset = int(x / int(CELL_OFFSET)) + 1;
+		int yOffset = (int(y / int(CELL_OFFSET)) + 1) * int(ONE_AXIS_CELLS);
+		return &cells[xOffset + yOffset];
+	}
+
+	// Retrieves a cell via their X, Y array coordinates
+	cell* 
+	getCellDiscrete(int x, int y)
+	{
+		return &cells[x + y * ONE_AXIS_CELLS];
+	}
+
+	// Fills the field with the distance from source to every cell of the grid
+	void
+	computeDistanceField(distanceField& field, int source)
+	{
+		unsigned char blocked[TOTAL_CELLS];
+		packBlocked(blocked);
+		field.compute(blocked, source);
+	}
+
+	// Builds the goal bounding boxes of the current map now, rather than in the first search that uses them
+	// Does nothing when the map doesn't use them ( see GOAL_BOUNDING )
+	void
+	buildGoalBounds()
+	{
+		if (!goalBounding)
+			return;
+
+		searchMap = snapshots.pin(snapshotReader);
+		pinBounds<NEIGHBOURHOOD>();
+		snapshots.unpin(snapshotReader);
+	}
+
+	// Removes the path status from cells, we could use the path to do this without checking all cells
+	// We don't do this since the debug modes also mark things as DISCOVERED
+	void
+	resetPath()
+	{
+		for (int i = 0; i < ONE_AXIS_CELLS; i++)
+			for (int j = 0; j < ONE_AXIS_CELLS; j++)
+				if (cells[i + j * ONE_AXIS_CELLS].type == PATH || cells[i + j * ONE_AXIS_CELLS].type == DISCOVERED)
+					cells[i + j * ONE_AXIS_CELLS].type = EMPTY;
+
+		pathExists = 0;
+		pathIndex = 0;
+	}
+
+	// Executes and plots the path created by the A* algorithm
+	void
+	pathfindGrid()
+	{
+		// When the path is found, mark each crossed cell with a type of PATH
+
+		if (!startExist || !goalExist)
+			return;
+
+		// Frequently requested goals get a shortest-path tree, after that every start is answered from it
+		// The distance field the trees are built from is plain 8-connected, other neighbourhoods always search
+		bool useTrees = std::is_same<NEIGHBOURHOOD, eightConnected>::value;
+		if (useTrees && trees.recordQuery(goalPosition))
+		{
+			distanceField field(ONE_AXIS_CELLS, ONE_AXIS_CELLS);
+			computeDistanceField(field, goalPosition);
+			trees.build(goalPosition, field);
+		}
+
+		std::vector<int> knownPath;
+		float knownCost;
+		if (cache.lookup(startPosition, goalPosition, ASTAR_SEARCH, knownPath, knownCost))
+			useKnownPath(knownPath, knownCost, "cached");
+		else if (useTrees && trees.lookup(startPosition, goalPosition, knownPath, knownCost))
+			useKnownPath(knownPath, knownCost, "tree");
+		else
+		{
+			Astar<NEIGHBOURHOOD, TIE_BREAKING>();
+			cache.store(startPosition, goalPosition, ASTAR_SEARCH, std::vector<int>(path, path + pathIndex), pathExists ? pathCost : -1, expandedCells);
+		}
+
+		// Same cells in the same order give the same hash, whichever build or source produced them
+		pathHash = hashPath(path, pathIndex);
+
+		if (printResults)
+		{
+			printf("Path hash: %016llx\n", (unsigned long long)pathHash);
+
+			const pathCacheStats& stats = cache.getStats();
+			printf("Path cache: %llu hits, %llu misses, %llu evictions, %llu invalidations\n", stats.hits, stats.misses, stats.evictions, stats.invalidations);
+
+			const pathTreeStats& treeStats = trees.getStats();
+			printf("Path trees: %llu hits, %llu built, %llu evictions\n", treeStats.hits, treeStats.built, treeStats.evictions);
+		}
+
+		// Draw Path
+		for (int i = 0; i < pathIndex; i++)
+		{
+			if(cells[path[i]].type != GOAL)
+				cells[path[i]].type = PATH;
+		}
+
+#if VALIDATE_DISTANCE_FIELD
+		validateDistanceField();
+#endif
+	}
+
+	// Searches with other policies than NEIGHBOURHOOD and TIE_BREAKING, the cache and the trees are skipped and nothing is drawn
+	// Headless checks use this to try every neighbourhood on the same grid
+	template <typename Neighbourhood, typename TieBreak>
+	void
+	searchWith()
+	{
+		pathExists = 0;
+		pathIndex = 0;
+		if (!startExist || !goalExist)
+			return;
+
+		// Cached heuristics are measured the NEIGHBOURHOOD way, another neighbourhood can't use them or leave its own behind
+		bool ownHeuristics = std::is_same<Neighbourhood, NEIGHBOURHOOD>::value;
+		if (!ownHeuristics)
+			heuristicStart = -1;
+
+		Astar<Neighbourhood, TieBreak>();
+		pathHash = hashPath(path, pathIndex);
+
+		if (!ownHeuristics)
+			heuristicStart = -1;
+	}
+
+	// Results of the last query
+	bool
+	hasPath() const
+	{
+		return pathExists;
+	}
+
+	float
+	getPathCost() const
+	{
+		return pathCost;
+	}
+
+	uint64_t
+	getPathHash() const
+	{
+		return pathHash;
+	}
+
+	// The path runs from the goal back to the start, the start itself isn't part of it
+	const int*
+	getPath() const
+	{
+		return path;
+	}
+
+	int
+	getPathLength() const
+	{
+		return pathIndex;
+	}
+
+private:
+#pragma region  PATHFINDING CODE
+
+	bool pathExists = 0;
+	
+	int path[TOTAL_CELLS];
+	int pathIndex = 0;
+	float pathCost = 0;
+	uint64_t pathHash = PATH_HASH_OFFSET;
+
+	// Cells expanded by the last search, the path cache needs these to know what the result depends on
+	std::vector<int> expandedCells;
+
+	// Which node of the discovery vector holds a cell, allocated once for the grid and reused by every search
+	nodeIndex discovered{ TOTAL_CELLS };
+
+	// What the running search works with, captured when it starts so edits made in the meantime can't change them
+	const gridVersion* searchMap = nullptr;
+	std::shared_ptr<const goalBounds> searchBounds;
+	int searchStart = 0;
+	int searchGoal = 0;
+
+	// Takes a path that didn't need a search, cost is below 0 when it is known that no path exists
+	void
+	useKnownPath(const std::vector<int>& knownPath, float cost, const char* source)
+	{
+		pathExists = cost >= 0;
+		pathCost = cost;
+		pathIndex = int(knownPath.size());
+		std::copy(knownPath.begin(), knownPath.end(), path);
+
+		if (!printResults)
+			return;
+
+		if (pathExists)
+			printf("Goal has been found! ( %s )\n", source);
+		else
+			printf("No path has been found. ( %s )\n", source);
+	}
+
+	// Packs the cells into one byte per cell, non-zero where the cell can't be crossed
+	void
+	packBlocked(unsigned char* blocked)
+	{
+		for (int i = 0; i < TOTAL_CELLS; i++)
+			blocked[i] = snapshots.isBlocked(i % ONE_AXIS_CELLS, i / ONE_AXIS_CELLS);
+	}
+
+#if VALIDATE_DISTANCE_FIELD
+	void
+	validateDistanceField()
+	{
+		unsigned char blocked[TOTAL_CELLS];
+		packBlocked(blocked);
+
+		distanceField field(ONE_AXIS_CELLS, ONE_AXIS_CELLS);
+		float maxError = field.validate(blocked, goalPosition);
+		printf("Distance field converged in %i sweeps, max error against Dijkstra: %f\n", field.getSweepCount(), maxError);
+	}
+#endif
+
+	int adj[8] = { -1 * ONE_AXIS_CELLS - 1, -1 * ONE_AXIS_CELLS, -1 * ONE_AXIS_CELLS + 1,
+				   -1,										   						   1,
+					    ONE_AXIS_CELLS - 1,	     ONE_AXIS_CELLS,      ONE_AXIS_CELLS + 1};
+
+	// Heuristic of every cell, worked out the first time a search needs it and kept for as long as the start stays the same
+	float heuristics[TOTAL_CELLS];
+	uint32_t heuristicStamps[TOTAL_CELLS] = {};
+	uint32_t heuristicStamp = 0;
+	int heuristicStart = -1;
+
+	// Estimated distance from a cell to the start ( the search runs backwards ), the neighbourhood decides how distance is measured
+	template <typename Neighbourhood>
+	float
+	getHeuristic(int x, int y)
+	{
+		int c = x + y * ONE_AXIS_CELLS;
+		if (heuristicStamps[c] != heuristicStamp)
+		{
+			heuristics[c] = Neighbourhood::heuristic(cells[searchStart].arrayX - x, cells[searchStart].arrayY - y);
+			heuristicStamps[c] = heuristicStamp;
+		}
+
+		return heuristics[c];
+	}
+
+	template <typename Neighbourhood>
+	node* 
+	createNode(int x, int y, node* parent, float stepCost)
+	{
+		float gCost = stepCost + parent->gCost;
+		float hCost = getHeuristic<Neighbourhood>(x, y);
+		float fCost = gCost + hCost;
+		return new node(gCost, hCost, fCost, &cells[x + y * ONE_AXIS_CELLS], parent);
+	}
+
+	// Ties between equal f costs are settled by the TieBreak policy
+	template <typename TieBreak>
+	node* 
+	findLowestFCost(std::vector<node*>& d)
+	{
+		if (d.empty())
+			return NULL;
+
+		node* lowest = NULL;
+
+		for (auto it = d.begin(); it != d.end(); it++)
+		{
+			if ((**it).visited)
+				continue;
+
+			if (lowest == NULL)
+			{
+				lowest = (*it);
+				continue;
+			}
+
+			if (TieBreak::better((**it).fCost, (**it).gCost, (**it).c->getArrayPos(), lowest->fCost, lowest->gCost, lowest->c->getArrayPos()))
+				lowest = (*it);
+		}
+		
+		return lowest;
+	}
+
+	template <typename Neighbourhood>
+	void 
+	addAndUpdateAdjacents(std::vector<node*> &d, node* n)
+	{
+		if (n == NULL)
+			return;
+
+		// One lookup tells us which of the 8 neighbours can be crossed, the neighbourhood then keeps the ones it allows
+		unsigned int moves = Neighbourhood::allowedMoves(searchMap->neighbourMask(n->c->arrayX, n->c->arrayY));
+		if (searchBounds)
+			moves &= searchBounds->directionsToward(n->c->getArrayPos(), searchStart);
+		Neighbourhood::forEachMove(moves, [&](int i, float stepCost) {
+			int offset = n->c->getArrayPos() + adj[i];
+
+			// Seen from the neighbour, n is the step in the opposite direction, which is 7 - i in adj order
+			int back = 7 - i;
+
+			int slot = discovered.find(offset);
+			if (slot < 0)
+			{
+				discovered.insert(offset, int(d.size()));
+				d.push_back(createNode<Neighbourhood>(cells[offset].arrayX, cells[offset].arrayY, n, stepCost));
+				d.back()->parentDirection = back;
+				return;
+			}
+
+			// A shorter route replaces the old one, and so does an equally short one through a lower direction ( see tieBreaking.h )
+			node* m = d[slot];
+			float gCost = n->gCost + stepCost;
+			if (gCost < m->gCost)
+			{
+				m->gCost = gCost;
+				m->fCost = gCost + m->hCost;
+				m->parent = n;
+				m->parentDirection = back;
+
+				// Everything reached through m got cheaper as well, so it has to be expanded again
+				m->visited = false;
+			}
+			else if (gCost == m->gCost && back < m->parentDirection)
+			{
+				m->parent = n;
+				m->parentDirection = back;
+			}
+		});
+	}
+
+	template <typename T>
+	inline void 
+	freeVector(std::vector<T> &v) 
+	{
+		// Free all pointers
+		for (std::vector<T>::iterator i = v.begin(); i != v.end(); ++i)
+			delete* i;
+
+		// Not necessary, but for completeness
+		v.clear();
+	}
+
+	// Executes the A* Pathfinding Algorithm, Neighbourhood is one of the policies in neighbourhood.h and TieBreak one in tieBreaking.h
+	// The path follows the canonical path rule described in tieBreaking.h, TieBreak only changes how much work it takes to get there
+	template <typename Neighbourhood, typename TieBreak>
+	void
+	Astar()
+	{
+		// Create a vector to store all discovered ( and visited ) nodes
+		std::vector<node*> discovery;
+		expandedCells.clear();
+
+		// Pin the current version of the grid, the whole search reads passability from it
+		searchMap = snapshots.pin(snapshotReader);
+		if (goalBounding)
+			searchBounds = pinBounds<Neighbourhood>();
+		searchStart = startPosition;
+		searchGoal = goalPosition;
+
+		// A new start makes every cached heuristic stale at once
+		if (searchStart != heuristicStart)
+		{
+			heuristicStart = searchStart;
+			heuristicStamp++;
+		}
+
+		// Create the goal node and add it to be explored on the vector
+		float goalHeuristic = getHeuristic<Neighbourhood>(cells[searchGoal].arrayX, cells[searchGoal].arrayY);
+		node* goalNode = new node(0, goalHeuristic, goalHeuristic, &cells[searchGoal], nullptr);
+		discovery.push_back(goalNode);
+		discovered.clear();
+		discovered.insert(searchGoal, 0);
+
+		// Until the start is reached and nothing left can give its path an equally short parent, or no path exists, we perform the algorithm
+		node* startNode = NULL;
+		while(1)
+		{
+			// Find the lowest cost, explorable, node in the frontier
+			node* n = findLowestFCost<TieBreak>(discovery);
+			if (n == NULL) // There are no more options, therefore we break the loop
+				break;
+
+			// Once the start is reached, nodes tying with its cost can still hand a cell of the path an equally short parent
+			if (startNode != NULL && n->fCost > startNode->gCost + PATH_TIE_EPSILON)
+				break;
+
+			// Mark node as visited
+			n->visited = true;
+
+			// The start is where the path ends, nothing is ever reached through it
+			if (n->c->getArrayPos() == searchStart)
+			{
+				startNode = n;
+				continue;
+			}
+
+			// Add all, viable, adjacent cells to the discovery vector and update all cells with better routes if such case exists
+			addAndUpdateAdjacents<Neighbourhood>(discovery, n);
+			expandedCells.push_back(n->c->getArrayPos());
+#if DRAW_VISITED_NODES
+			// If the node is not the goal node, then mark it to be drawn as a visited/discovered node
+			if(n->c->type != GOAL)
+				n->c->type = DISCOVERED;
+#endif
+		}
+
+		if (startNode != NULL) // We reached the start, therefore a path exists
+		{
+			// Print that a path exists
+			if (printResults)
+				printf("Goal has been found!\n");
+			pathExists = 1;
+			pathCost = startNode->gCost;
+
+			// Parents lead from the start to the goal, store them and flip them around since the path is kept goal first
+			for (node* pathNode = startNode->parent; pathNode != NULL; pathNode = pathNode->parent)
+				path[pathIndex++] = pathNode->c->getArrayPos();
+			std::reverse(path, path + pathIndex);
+		}
+		else if (printResults)
+			printf("No path has been found.");
+
+		// Frees the memory in the vector and lets go of the grid version before returning from the pathfinding function
+		freeVector(discovery);
+		searchBounds.reset();
+		snapshots.unpin(snapshotReader);
+	}
+
+	// Returns the goal bounding boxes of the pinned snapshot, building them from it when the grid has none for it yet
+	template <typename Neighbourhood>
+	std::shared_ptr<const goalBounds>
+	pinBounds()
+	{
+		// The grid only keeps boxes for its own neighbourhood, searches with another one build theirs every time
+		bool shared = std::is_same<Neighbourhood, NEIGHBOURHOOD>::value;
+		std::shared_ptr<const goalBounds> current = shared ? std::atomic_load(&bounds) : nullptr;
+		if (current && current->getMapVersion() == searchMap->getNumber())
+			return current;
+
+		unsigned char blocked[TOTAL_CELLS];
+		for (int i = 0; i < TOTAL_CELLS; i++)
+			blocked[i] = searchMap->isBlocked(i % ONE_AXIS_CELLS, i / ONE_AXIS_CELLS);
+
+		std::shared_ptr<goalBounds> built = std::make_shared<goalBounds>(ONE_AXIS_CELLS, ONE_AXIS_CELLS);
+		built->build<Neighbourhood>(blocked, GOAL_BOUNDING_THREADS);
+		built->setMapVersion(searchMap->getNumber());
+
+		// Boxes of an older snapshot are of no use to anyone else, only newer ones are handed to the grid
+		if (shared && (!current || current->getMapVersion() < built->getMapVersion()))
+			std::atomic_store(&bounds, std::shared_ptr<const goalBounds>(built));
+
+		return built;
+	}
+
+#pragma endregion
+	
+};
+
+#pragma endregion
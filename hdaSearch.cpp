@@ -0,0 +1,386 @@
+#include "hdaSearch.h"
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <thread>
+
+#include "neighbourhood.h"
+#include "versionedGrid.h"
+
+// Messages per batch, and how many nodes a worker expands between looks at its queue
+#define MESSAGE_BATCH_SIZE 128
+#define EXPANSIONS_PER_ROUND 64
+
+// One active worker in the pending counter, messages in flight count in the lower half
+#define ACTIVE_WORKER (uint64_t(1) << 32)
+
+namespace {
+	struct openEntry {
+		float fCost;
+		float gCost;
+		int cell;
+
+		// Lowest f first, deeper nodes first on ties
+		bool operator<(const openEntry& o) const
+		{
+			if (fCost != o.fCost)
+				return fCost > o.fCost;
+			return gCost < o.gCost;
+		}
+	};
+}
+
+struct hdaSearch::messageBatch {
+	messageBatch* next = nullptr;
+
+	// Worker that fills this batch, it goes back there once it has been read
+	unsigned int owner;
+
+	int count = 0;
+	searchMessage messages[MESSAGE_BATCH_SIZE];
+};
+
+struct hdaSearch::worker {
+	// Batches sent to this worker, and batches of this worker that have been read and came back
+	std::atomic<messageBatch*> inbox{ nullptr };
+	std::atomic<messageBatch*> returned{ nullptr };
+
+	// Everything below is only touched by the worker's own thread
+	std::priority_queue<openEntry> open;
+
+	// The batch being filled for every other worker, and empty batches ready to be filled
+	std::vector<messageBatch*> outgoing;
+	std::vector<messageBatch*> spare;
+
+	// Every batch this worker ever allocated, so they can be freed wherever they ended up
+	std::vector<messageBatch*> allocated;
+
+	// Nodes of the cells this worker owns
+	std::vector<searchNode> nodes;
+
+	std::vector<int> expanded;
+	hdaStats stats;
+};
+
+hdaSearch::hdaSearch(int width, int height, unsigned int threadCount) : width{ width }, height{ height }, threadCount{ threadCount }, discovered{ width * height }
+{
+	if (this->threadCount == 0)
+		this->threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	for (unsigned int i = 0; i < this->threadCount; i++)
+	{
+		workers.push_back(new worker());
+		workers.back()->outgoing.assign(this->threadCount, nullptr);
+	}
+}
+
+hdaSearch::~hdaSearch()
+{
+	for (worker* w : workers)
+	{
+		for (messageBatch* b : w->allocated)
+			delete b;
+		delete w;
+	}
+}
+
+template <typename Neighbourhood>
+float
+hdaSearch::findPath(const gridVersion* map, int start, int goal, std::vector<int>& path)
+{
+	path.clear();
+	expandedCells.clear();
+	stats = hdaStats();
+
+	if (map->isBlocked(start % width, start / width) || map->isBlocked(goal % width, goal / width))
+		return -1;
+	if (start == goal)
+		return 0;
+
+	discovered.clear();
+	for (worker* w : workers)
+	{
+		w->open = std::priority_queue<openEntry>();
+		w->nodes.clear();
+		w->expanded.clear();
+		w->stats = hdaStats();
+	}
+
+	bestCost.store(std::numeric_limits<float>::infinity());
+	pending.store(uint64_t(threadCount) * ACTIVE_WORKER);
+
+	// Like the grid's A* the search runs from the goal to the start
+	worker* goalOwner = workers[ownerOf(goal)];
+	discovered.insert(goal, 0);
+	goalOwner->nodes.push_back(searchNode{ 0.f, 8 });
+	float goalHeuristic = Neighbourhood::heuristic(start % width - goal % width, start / width - goal / width);
+	goalOwner->open.push(openEntry{ goalHeuristic, 0.f, goal });
+
+	// The calling thread is worker 0
+	std::vector<std::thread> threads;
+	for (unsigned int i = 1; i < threadCount; i++)
+		threads.emplace_back(&hdaSearch::runWorker<Neighbourhood>, this, i, map, start);
+	runWorker<Neighbourhood>(0, map, start);
+
+	for (std::thread& t : threads)
+		t.join();
+
+	for (worker* w : workers)
+	{
+		stats.expansions += w->stats.expansions;
+		stats.messages += w->stats.messages;
+		stats.batches += w->stats.batches;
+		if (recordExpanded)
+			expandedCells.insert(expandedCells.end(), w->expanded.begin(), w->expanded.end());
+	}
+
+	float cost = bestCost.load();
+	if (cost == std::numeric_limits<float>::infinity())
+		return -1;
+
+	// Parents lead from the start to the goal, every one of them was set with a strictly lower g than its child so this
+	// always ends at the goal. The path is kept goal first, like the grid keeps it
+	for (int c = start; c != goal;)
+	{
+		int direction = nodeOf(c).parentDirection;
+		c += neighbourDx[direction] + neighbourDy[direction] * width;
+		path.push_back(c);
+	}
+	std::reverse(path.begin(), path.end());
+
+	return cost;
+}
+
+void
+hdaSearch::setRecordExpanded(bool record)
+{
+	recordExpanded = record;
+}
+
+unsigned int
+hdaSearch::getThreadCount() const
+{
+	return threadCount;
+}
+
+const std::vector<int>&
+hdaSearch::getExpandedCells() const
+{
+	return expandedCells;
+}
+
+const hdaStats&
+hdaSearch::getStats() const
+{
+	return stats;
+}
+
+template <typename Neighbourhood>
+void
+hdaSearch::runWorker(unsigned int self, const gridVersion* map, int start)
+{
+	worker& w = *workers[self];
+	int startX = start % width;
+	int startY = start / width;
+
+	// Only ever called for cells this worker owns
+	// Equally short routes keep the parent direction the grid's A* keeps ( see tieBreaking.h ), so the path doesn't depend on
+	// which message came first and is the same path the grid finds
+	auto relax = [&](int cell, int parentDirection, float gCost) {
+		int slot = discovered.find(cell);
+		if (slot < 0)
+		{
+			discovered.insert(cell, int(w.nodes.size()));
+			w.nodes.push_back(searchNode{ gCost, uint8_t(parentDirection) });
+		}
+		else
+		{
+			searchNode& n = w.nodes[slot];
+			if (gCost >= n.gCost)
+			{
+				if (gCost == n.gCost && parentDirection < n.parentDirection)
+					n.parentDirection = uint8_t(parentDirection);
+				return;
+			}
+
+			n.gCost = gCost;
+			n.parentDirection = uint8_t(parentDirection);
+		}
+
+		// The start is where the path ends, reaching it is enough
+		if (cell == start)
+		{
+			offerBestCost(gCost);
+			return;
+		}
+
+		float hCost = Neighbourhood::heuristic(startX - cell % width, startY - cell / width);
+		w.open.push(openEntry{ gCost + hCost, gCost, cell });
+	};
+
+	// Messages are counted as pending before they are pushed, so the receiver can never count them down first
+	auto flush = [&](unsigned int to) {
+		messageBatch*& batch = w.outgoing[to];
+		pending.fetch_add(uint64_t(batch->count));
+		w.stats.messages += batch->count;
+		w.stats.batches++;
+
+		pushBatch(workers[to]->inbox, batch);
+		batch = nullptr;
+	};
+
+	auto send = [&](unsigned int to, int cell, int parentDirection, float gCost) {
+		messageBatch*& batch = w.outgoing[to];
+		if (batch == nullptr)
+			batch = takeBatch(self);
+
+		batch->messages[batch->count++] = searchMessage{ cell, parentDirection, gCost };
+		if (batch->count == MESSAGE_BATCH_SIZE)
+			flush(to);
+	};
+
+	bool active = true;
+	while (true)
+	{
+		messageBatch* received = w.inbox.exchange(nullptr, std::memory_order_acquire);
+		if (received != nullptr)
+		{
+			// Active again before the messages stop counting as pending, so the counter can't touch 0 in between
+			if (!active)
+			{
+				pending.fetch_add(ACTIVE_WORKER);
+				active = true;
+			}
+
+			uint64_t handled = 0;
+			while (received != nullptr)
+			{
+				messageBatch* next = received->next;
+				for (int i = 0; i < received->count; i++)
+					relax(received->messages[i].cell, received->messages[i].parentDirection, received->messages[i].gCost);
+
+				handled += received->count;
+				received->count = 0;
+				pushBatch(workers[received->owner]->returned, received);
+				received = next;
+			}
+
+			pending.fetch_sub(handled);
+		}
+
+		if (!active)
+		{
+			if (pending.load() == 0)
+				break;
+
+			std::this_thread::yield();
+			continue;
+		}
+
+		for (int n = 0; n < EXPANSIONS_PER_ROUND && !w.open.empty(); n++)
+		{
+			openEntry e = w.open.top();
+			w.open.pop();
+
+			// A better route to the cell came in after this entry was pushed
+			if (e.gCost > w.nodes[discovered.find(e.cell)].gCost)
+				continue;
+
+			// Nothing left here can beat or tie the best path, and the best path only gets better
+			// Nodes tying with it are still expanded, they may hand a cell of the path an equally short parent
+			if (e.fCost > bestCost.load(std::memory_order_relaxed) + PATH_TIE_EPSILON)
+			{
+				w.open = std::priority_queue<openEntry>();
+				break;
+			}
+
+			w.stats.expansions++;
+			if (recordExpanded)
+				w.expanded.push_back(e.cell);
+
+			unsigned int moves = Neighbourhood::allowedMoves(map->neighbourMask(e.cell % width, e.cell / width));
+			Neighbourhood::forEachMove(moves, [&](int i, float stepCost) {
+				int next = e.cell + neighbourDx[i] + neighbourDy[i] * width;
+
+				// Seen from the neighbour, this cell is the step in the opposite direction
+				int back = 7 - i;
+				unsigned int to = ownerOf(next);
+				if (to == self)
+					relax(next, back, e.gCost + stepCost);
+				else
+					send(to, next, back, e.gCost + stepCost);
+			});
+		}
+
+		// Everything this round produced goes out before we can go idle
+		for (unsigned int to = 0; to < threadCount; to++)
+			if (w.outgoing[to] != nullptr && w.outgoing[to]->count > 0)
+				flush(to);
+
+		if (w.open.empty())
+		{
+			active = false;
+			pending.fetch_sub(ACTIVE_WORKER);
+		}
+	}
+}
+
+void
+hdaSearch::pushBatch(std::atomic<messageBatch*>& stack, messageBatch* batch)
+{
+	messageBatch* head = stack.load(std::memory_order_relaxed);
+	do
+	{
+		batch->next = head;
+	} while (!stack.compare_exchange_weak(head, batch, std::memory_order_release, std::memory_order_relaxed));
+}
+
+hdaSearch::messageBatch*
+hdaSearch::takeBatch(unsigned int self)
+{
+	worker& w = *workers[self];
+	if (w.spare.empty())
+	{
+		for (messageBatch* b = w.returned.exchange(nullptr, std::memory_order_acquire); b != nullptr; b = b->next)
+			w.spare.push_back(b);
+	}
+
+	if (w.spare.empty())
+	{
+		messageBatch* b = new messageBatch();
+		b->owner = self;
+		w.allocated.push_back(b);
+		return b;
+	}
+
+	messageBatch* b = w.spare.back();
+	w.spare.pop_back();
+	return b;
+}
+
+unsigned int
+hdaSearch::ownerOf(int cell) const
+{
+	return ((uint32_t(cell) * 0x9E3779B1u) >> 16) % threadCount;
+}
+
+hdaSearch::searchNode&
+hdaSearch::nodeOf(int cell)
+{
+	return workers[ownerOf(cell)]->nodes[discovered.find(cell)];
+}
+
+void
+hdaSearch::offerBestCost(float cost)
+{
+	float best = bestCost.load();
+	while (cost < best && !bestCost.compare_exchange_weak(best, cost))
+	{
+	}
+}
+
+// The searches only ever use these
+template float hdaSearch::findPath<fourConnected>(const gridVersion*, int, int, std::vector<int>&);
+template float hdaSearch::findPath<eightConnected>(const gridVersion*, int, int, std::vector<int>&);
+template float hdaSearch::findPath<eightConnectedNoCornerCutting>(const gridVersion*, int, int, std::vector<int>&);
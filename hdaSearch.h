@@ -0,0 +1,116 @@
+#pragma once
+
+/*
+	Hash-distributed A* ( HDA* ) for single long queries
+
+	Running many queries at once doesn't help when one query is the bottleneck, so this splits a single A* over several
+	threads. Every cell is owned by one worker, picked by hashing its index. A worker only ever expands, relaxes and
+	stores the cells it owns: when expanding a cell produces a neighbour owned by someone else, the neighbour is sent to
+	its owner as a message ( cell, g, parent ) instead. Hashing spreads the frontier evenly, so every worker stays busy.
+
+	Messages travel in batches through one lock-free queue per worker. Any worker can push a batch onto a queue with a
+	compare-and-swap, and only the owner takes them off, all at once with an exchange, so the queues are multi-producer
+	single-consumer and never block. Used batches go back to the worker that filled them the same way, so nothing is
+	allocated once the search has warmed up.
+
+	Workers keep going until no open node can beat or tie the best path found so far, which makes the result optimal like
+	serial A*. The search is over once every worker is idle and no message is in flight. Both are kept in one atomic
+	counter ( active workers in the upper half, messages sent but not yet handled in the lower half ), so a single load
+	sees both at the same instant. A worker counts itself active again before the messages it took off its queue stop
+	counting, and counts messages before it sends them, so the counter only reaches 0 when there really is nothing left to do.
+
+	The map is the same copy-on-write gridVersion the grid's A* reads from, and the search follows the canonical path rule
+	in tieBreaking.h. Since nodes that tie with the best path are still expanded, every equally short parent gets its say,
+	so the result doesn't depend on thread timing. The same query comes back as the same path ( and
+	path hash ) as the grid's A* gives, for any number of threads.
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "nodeIndex.h"
+
+class gridVersion;
+
+struct hdaStats {
+	unsigned long long expansions = 0;
+	unsigned long long messages = 0;
+	unsigned long long batches = 0;
+};
+
+class hdaSearch {
+/// Variables
+private:
+	struct searchMessage {
+		int cell;
+		int parentDirection;
+		float gCost;
+	};
+
+	// A parent is stored as the direction of the step to it, in the order of neighbourhood.h
+	struct searchNode {
+		float gCost;
+		uint8_t parentDirection;
+	};
+
+	struct messageBatch;
+	struct worker;
+
+	int width, height;
+	unsigned int threadCount;
+
+	// Which node of its owner's node vector holds a cell, every entry is only ever written by the worker owning the cell
+	nodeIndex discovered;
+
+	std::vector<worker*> workers;
+
+	// Best path cost found so far, open nodes with an f above it can't lead anywhere as good
+	std::atomic<float> bestCost;
+
+	// Active workers << 32 | messages in flight, the search is over when it reads 0
+	std::atomic<uint64_t> pending;
+
+	bool recordExpanded = false;
+	std::vector<int> expandedCells;
+
+	hdaStats stats;
+
+/// Functions & Methods
+public:
+	// Constructor & Deconstructor, threadCount of 0 uses one thread per hardware thread
+	hdaSearch(int width, int height, unsigned int threadCount);
+	~hdaSearch();
+
+	// Searches for an optimal path from start to goal on map, Neighbourhood is one of the policies in neighbourhood.h
+	// path is filled from the goal back to the start ( the start itself isn't included ), the same order the grid uses
+	// Returns the cost of the path, or -1 if there is none
+	template <typename Neighbourhood>
+	float findPath(const gridVersion* map, int start, int goal, std::vector<int>& path);
+
+	// Keep every expanded cell so getExpandedCells can report them, off by default since it costs memory on large maps
+	void setRecordExpanded(bool record);
+
+	// Getters
+	unsigned int getThreadCount() const;
+	const std::vector<int>& getExpandedCells() const;
+	const hdaStats& getStats() const;
+
+private:
+	template <typename Neighbourhood>
+	void runWorker(unsigned int self, const gridVersion* map, int start);
+
+	// Lock-free push onto one of the batch stacks, any thread may push but only the stack's worker takes from it
+	static void pushBatch(std::atomic<messageBatch*>& stack, messageBatch* batch);
+
+	// Returns an empty batch owned by the worker, reusing the ones that came back before allocating
+	messageBatch* takeBatch(unsigned int self);
+
+	unsigned int ownerOf(int cell) const;
+
+	// The node of a cell the search has reached
+	searchNode& nodeOf(int cell);
+
+	// Lowers the best path cost to cost if it is lower
+	void offerBestCost(float cost);
+};
@@ -0,0 +1,174 @@
+#include "mapFile.h"
+
+#include <cstring>
+
+// Longest scenario line that can be read, map names are limited to 1023 characters
+#define SCENARIO_LINE_LENGTH 2048
+
+bool
+readMapFile(const std::string& path, int& width, int& height, std::vector<unsigned char>& blocked)
+{
+	FILE* file = fopen(path.c_str(), "r");
+	if (file == nullptr)
+	{
+		printf("ERROR::Map file %s could not be opened\n", path.c_str());
+		return false;
+	}
+
+	// The header lines can come in any order, "map" ends it
+	width = -1;
+	height = -1;
+	char word[64];
+	while (fscanf(file, "%63s", word) == 1 && strcmp(word, "map") != 0)
+	{
+		if (strcmp(word, "width") == 0 && fscanf(file, "%d", &width) != 1)
+			break;
+		if (strcmp(word, "height") == 0 && fscanf(file, "%d", &height) != 1)
+			break;
+	}
+
+	if (width <= 0 || height <= 0 || strcmp(word, "map") != 0)
+	{
+		printf("ERROR::Map file %s has no valid header\n", path.c_str());
+		fclose(file);
+		return false;
+	}
+
+	blocked.assign(size_t(width) * height, 1);
+	for (int y = 0; y < height; y++)
+	{
+		char row[4096];
+		if (fscanf(file, "%4095s", row) != 1 || int(strlen(row)) < width)
+		{
+			printf("ERROR::Map file %s ends or is too narrow at row %i\n", path.c_str(), y);
+			fclose(file);
+			return false;
+		}
+
+		for (int x = 0; x < width; x++)
+			blocked[x + y * width] = !(row[x] == '.' || row[x] == 'G' || row[x] == 'S');
+	}
+
+	fclose(file);
+	return true;
+}
+
+bool
+writeMapFile(const std::string& path, int width, int height, const std::vector<unsigned char>& blocked)
+{
+	FILE* file = fopen(path.c_str(), "w");
+	if (file == nullptr)
+	{
+		printf("ERROR::Map file %s could not be created\n", path.c_str());
+		return false;
+	}
+
+	fprintf(file, "type octile\nheight %i\nwidth %i\nmap\n", height, width);
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+			fputc(blocked[x + y * width] ? '@' : '.', file);
+		fputc('\n', file);
+	}
+
+	bool ok = !ferror(file);
+	fclose(file);
+	return ok;
+}
+
+bool
+writeScenarioFile(const std::string& path, const std::string& mapName, int width, int height, const std::vector<scenarioQuery>& queries)
+{
+	FILE* file = fopen(path.c_str(), "w");
+	if (file == nullptr)
+	{
+		printf("ERROR::Scenario file %s could not be created\n", path.c_str());
+		return false;
+	}
+
+	fprintf(file, "version 1\n");
+	for (const scenarioQuery& q : queries)
+		fprintf(file, "0\t%s\t%i\t%i\t%i\t%i\t%i\t%i\t%.8f\n", mapName.c_str(), width, height, q.startX, q.startY, q.goalX, q.goalY, q.expectedCost);
+
+	bool ok = !ferror(file);
+	fclose(file);
+	return ok;
+}
+
+scenarioReader::scenarioReader(const std::string& path)
+{
+	file = fopen(path.c_str(), "r");
+	if (file == nullptr)
+	{
+		fprintf(stderr, "ERROR::Scenario file %s could not be opened\n", path.c_str());
+		return;
+	}
+
+	// The version line is optional
+	char first[SCENARIO_LINE_LENGTH];
+	float version;
+	if (fgets(first, sizeof(first), file) != nullptr && sscanf(first, " version %f", &version) == 1)
+		line = 1;
+	else
+		rewind(file);
+}
+
+scenarioReader::~scenarioReader()
+{
+	if (file)
+		fclose(file);
+}
+
+SCENARIO_LINE
+scenarioReader::next(scenarioQuery& query)
+{
+	if (file == nullptr)
+		return SCENARIO_END;
+
+	// Whole lines are read before they are parsed, so a bad line never leaves the file halfway through it
+	char text[SCENARIO_LINE_LENGTH];
+	while (fgets(text, sizeof(text), file) != nullptr)
+	{
+		line++;
+
+		// A line too long for the buffer is unreadable anyway, the rest of it is skipped
+		bool complete = strchr(text, '\n') != nullptr || feof(file);
+		if (!complete)
+		{
+			int c;
+			while ((c = fgetc(file)) != EOF && c != '\n')
+			{
+			}
+		}
+
+		if (complete && text[strspn(text, " \t\r\n")] == '\0')
+			continue;
+
+		int bucket, mapWidth, mapHeight, end = 0;
+		char mapName[1024];
+		int read = sscanf(text, "%d %1023s %d %d %d %d %d %d %lf %n", &bucket, mapName, &mapWidth, &mapHeight,
+			&query.startX, &query.startY, &query.goalX, &query.goalY, &query.expectedCost, &end);
+		if (!complete || read != 9 || text[end] != '\0')
+		{
+			// Kept apart from the results, which may be going to the console
+			fprintf(stderr, "ERROR::Scenario line %i could not be read\n", line);
+			return SCENARIO_UNREADABLE;
+		}
+
+		return SCENARIO_QUERY;
+	}
+
+	return SCENARIO_END;
+}
+
+bool
+scenarioReader::isOpen() const
+{
+	return file != nullptr;
+}
+
+int
+scenarioReader::getLine() const
+{
+	return line;
+}
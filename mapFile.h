@@ -0,0 +1,73 @@
+#pragma once
+
+/*
+	Map and scenario files
+
+	Maps and queries are stored in the formats of the Moving AI grid pathfinding benchmarks, so maps saved from the
+	viewer and maps from those benchmark sets can be used interchangeably.
+
+	A map file is a short header followed by one character per cell, row by row:
+
+		type octile
+		height 20
+		width 20
+		map
+		....@@..............
+		...
+
+	'.', 'G' and 'S' are passable, anything else ( '@', 'O', 'T', 'W' ) is blocked.
+
+	A scenario file starts with "version 1" and holds one query per line, tab separated:
+
+		bucket  map  mapWidth  mapHeight  startX  startY  goalX  goalY  expectedCost
+
+	Coordinates are 0 based with y going down. An expected cost below 0 means no path should be found.
+*/
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// What scenarioReader::next found on the next line
+typedef enum {
+	SCENARIO_QUERY,
+	SCENARIO_UNREADABLE,
+	SCENARIO_END
+} SCENARIO_LINE;
+
+struct scenarioQuery {
+	int startX = 0, startY = 0;
+	int goalX = 0, goalY = 0;
+	double expectedCost = 0;
+};
+
+// Reads a map file, blocked is filled with width * height bytes, non-zero where a cell can't be crossed
+bool readMapFile(const std::string& path, int& width, int& height, std::vector<unsigned char>& blocked);
+
+// Writes blocked ( width * height bytes ) as a map file
+bool writeMapFile(const std::string& path, int width, int height, const std::vector<unsigned char>& blocked);
+
+// Writes queries as a scenario file for the map mapName
+bool writeScenarioFile(const std::string& path, const std::string& mapName, int width, int height, const std::vector<scenarioQuery>& queries);
+
+// Reads a scenario file one query at a time, so files of any length can be replayed
+class scenarioReader {
+/// Variables
+private:
+	FILE* file = nullptr;
+	int line = 0;
+
+/// Functions & Methods
+public:
+	// Constructor & Deconstructor
+	scenarioReader(const std::string& path);
+	~scenarioReader();
+
+	// Reads the next query, blank lines are skipped
+	// A line that can't be read is reported as SCENARIO_UNREADABLE and the next call carries on with the line after it
+	SCENARIO_LINE next(scenarioQuery& query);
+
+	// Getters
+	bool isOpen() const;
+	int getLine() const;
+};
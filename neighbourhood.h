@@ -0,0 +1,178 @@
+#pragma once
+
+/*
+	Neighbourhood policies
+
+	Which cells count as neighbours ( and what a step to them costs ) is picked at compile time by handing one of these
+	to a search as a template argument. Every policy spells out its own neighbour loop, so each search gets a fully
+	unrolled loop made for that neighbourhood and never has to ask at runtime which one it is using.
+
+		fourConnected                 - straight steps only, Manhattan heuristic
+		eightConnected                - straight and diagonal steps, diagonals may squeeze between two diagonal walls
+		eightConnectedNoCornerCutting - same as above, but a diagonal step needs both straight cells beside it to be free
+
+	Policies take the passable mask from neighbourMask ( of passabilityBitmap or gridVersion ), bit i being the i-th neighbour in the order
+	NW, N, NE, W, E, SW, S, SE, and call visit( direction, step cost ) for every neighbour the search may step to.
+	allowedMoves and forEachMove do the same in two parts, so a search can drop more moves ( e.g. with goal bounding )
+	in between. forEachMove expects a mask that has already been through allowedMoves.
+*/
+
+#include <cstdlib>
+
+// Bit of every direction in a neighbour mask
+#define NEIGHBOUR_NW (1u << 0)
+#define NEIGHBOUR_N (1u << 1)
+#define NEIGHBOUR_NE (1u << 2)
+#define NEIGHBOUR_W (1u << 3)
+#define NEIGHBOUR_E (1u << 4)
+#define NEIGHBOUR_SW (1u << 5)
+#define NEIGHBOUR_S (1u << 6)
+#define NEIGHBOUR_SE (1u << 7)
+
+#define NEIGHBOUR_STRAIGHT_COST 1.f
+#define NEIGHBOUR_DIAGONAL_COST 1.41421356f
+
+// Turns the blocked bits of x - 1, x and x + 1 in the rows above, at and below a cell into its neighbour mask
+// Every passability store reads its three rows its own way and leaves the bit shuffling to this
+inline unsigned int
+neighbourMaskFromRows(unsigned int top, unsigned int middle, unsigned int bottom)
+{
+	top = ~top & 7;
+	middle = ~middle & 7;
+	bottom = ~bottom & 7;
+
+	// The middle row contributes its outer two bits only, the cell itself isn't a neighbour
+	return top | ((middle & 1) << 3) | ((middle & 4) << 2) | (bottom << 5);
+}
+
+// Two route costs this close count as equally short, summed diagonal costs aren't exact
+// Every search and goal bounding use the same slack, so they all agree on which routes tie
+#define PATH_TIE_EPSILON 0.001f
+
+// Offset of every direction, in the same order as the bits above
+static const int neighbourDx[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+static const int neighbourDy[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+
+// Cost of a single step in direction
+inline float
+neighbourStepCost(int direction)
+{
+	return neighbourDx[direction] != 0 && neighbourDy[direction] != 0 ? NEIGHBOUR_DIAGONAL_COST : NEIGHBOUR_STRAIGHT_COST;
+}
+
+struct fourConnected {
+	// Removes the moves this neighbourhood doesn't have from a passable mask
+	static unsigned int
+	allowedMoves(unsigned int passable)
+	{
+		return passable & (NEIGHBOUR_N | NEIGHBOUR_W | NEIGHBOUR_E | NEIGHBOUR_S);
+	}
+
+	template <typename Visit>
+	static void
+	forEachMove(unsigned int moves, Visit&& visit)
+	{
+		if (moves & NEIGHBOUR_N)
+			visit(1, NEIGHBOUR_STRAIGHT_COST);
+		if (moves & NEIGHBOUR_W)
+			visit(3, NEIGHBOUR_STRAIGHT_COST);
+		if (moves & NEIGHBOUR_E)
+			visit(4, NEIGHBOUR_STRAIGHT_COST);
+		if (moves & NEIGHBOUR_S)
+			visit(6, NEIGHBOUR_STRAIGHT_COST);
+	}
+
+	template <typename Visit>
+	static void
+	forEachNeighbour(unsigned int passable, Visit&& visit)
+	{
+		forEachMove(passable, visit);
+	}
+
+	// Manhattan distance
+	static float
+	heuristic(int dx, int dy)
+	{
+		return float(std::abs(dx) + std::abs(dy));
+	}
+};
+
+struct eightConnected {
+	static unsigned int
+	allowedMoves(unsigned int passable)
+	{
+		return passable;
+	}
+
+	template <typename Visit>
+	static void
+	forEachMove(unsigned int moves, Visit&& visit)
+	{
+		if (moves & NEIGHBOUR_NW)
+			visit(0, NEIGHBOUR_DIAGONAL_COST);
+		if (moves & NEIGHBOUR_N)
+			visit(1, NEIGHBOUR_STRAIGHT_COST);
+		if (moves & NEIGHBOUR_NE)
+			visit(2, NEIGHBOUR_DIAGONAL_COST);
+		if (moves & NEIGHBOUR_W)
+			visit(3, NEIGHBOUR_STRAIGHT_COST);
+		if (moves & NEIGHBOUR_E)
+			visit(4, NEIGHBOUR_STRAIGHT_COST);
+		if (moves & NEIGHBOUR_SW)
+			visit(5, NEIGHBOUR_DIAGONAL_COST);
+		if (moves & NEIGHBOUR_S)
+			visit(6, NEIGHBOUR_STRAIGHT_COST);
+		if (moves & NEIGHBOUR_SE)
+			visit(7, NEIGHBOUR_DIAGONAL_COST);
+	}
+
+	template <typename Visit>
+	static void
+	forEachNeighbour(unsigned int passable, Visit&& visit)
+	{
+		forEachMove(passable, visit);
+	}
+
+	// Octile distance
+	static float
+	heuristic(int dx, int dy)
+	{
+		dx = std::abs(dx);
+		dy = std::abs(dy);
+		return dx > dy ? dx + (NEIGHBOUR_DIAGONAL_COST - NEIGHBOUR_STRAIGHT_COST) * dy : dy + (NEIGHBOUR_DIAGONAL_COST - NEIGHBOUR_STRAIGHT_COST) * dx;
+	}
+};
+
+struct eightConnectedNoCornerCutting {
+	// Every diagonal bit is ANDed with the two straight bits beside it, shifted onto it, so there are no branches
+	static unsigned int
+	allowedMoves(unsigned int passable)
+	{
+		unsigned int straight = passable & (NEIGHBOUR_N | NEIGHBOUR_W | NEIGHBOUR_E | NEIGHBOUR_S);
+		unsigned int northWest = passable & (passable >> 1) & (passable >> 3) & NEIGHBOUR_NW;
+		unsigned int northEast = passable & (passable << 1) & (passable >> 2) & NEIGHBOUR_NE;
+		unsigned int southWest = passable & (passable << 2) & (passable >> 1) & NEIGHBOUR_SW;
+		unsigned int southEast = passable & (passable << 3) & (passable << 1) & NEIGHBOUR_SE;
+		return straight | northWest | northEast | southWest | southEast;
+	}
+
+	template <typename Visit>
+	static void
+	forEachMove(unsigned int moves, Visit&& visit)
+	{
+		eightConnected::forEachMove(moves, visit);
+	}
+
+	template <typename Visit>
+	static void
+	forEachNeighbour(unsigned int passable, Visit&& visit)
+	{
+		forEachMove(allowedMoves(passable), visit);
+	}
+
+	static float
+	heuristic(int dx, int dy)
+	{
+		return eightConnected::heuristic(dx, dy);
+	}
+};
@@ -0,0 +1,47 @@
+#include "nodeIndex.h"
+
+#include <algorithm>
+
+nodeIndex::nodeIndex(int cellCount)
+{
+	entries.assign(cellCount, 0);
+	clear();
+}
+
+void
+nodeIndex::clear()
+{
+	search++;
+
+	// After 2^32 searches old entries could look current again, so start over from a clean table
+	if (search == 0)
+	{
+		std::fill(entries.begin(), entries.end(), 0);
+		search = 1;
+	}
+}
+
+void
+nodeIndex::insert(int cell, int slot)
+{
+	entries[cell] = (uint64_t(search) << 32) | uint32_t(slot);
+}
+
+int
+nodeIndex::find(int cell) const
+{
+	uint64_t entry = entries[cell];
+	return uint32_t(entry >> 32) == search ? int(uint32_t(entry)) : -1;
+}
+
+bool
+nodeIndex::contains(int cell) const
+{
+	return uint32_t(entries[cell] >> 32) == search;
+}
+
+int
+nodeIndex::getCellCount() const
+{
+	return int(entries.size());
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+/*
+	Dense cell to search node index
+
+	Searches keep their nodes in a vector and need to know, for a cell, whether it already has a node and which one.
+	Scanning the vector for that makes every expansion linear in the number of discovered nodes. This keeps one entry
+	per cell of the map instead, so both questions are answered by a single array load.
+
+	Every entry packs the search it was written in ( upper 32 bits ) with the node slot ( lower 32 bits ). Starting a new
+	search only bumps the current search number, which makes every old entry stale without touching the table, so the
+	index is allocated once per map size and reused by every search that runs on it ( A*, Dijkstra, bidirectional, ... ).
+	A bidirectional search simply keeps one index per direction.
+*/
+
+#include <cstdint>
+#include <vector>
+
+class nodeIndex {
+/// Variables
+private:
+	std::vector<uint64_t> entries;
+	uint32_t search = 0;
+
+/// Functions & Methods
+public:
+	// Constructor, cellCount is the number of cells of the map the searches run on
+	nodeIndex(int cellCount);
+
+	// Forgets every node, call this when a new search starts
+	void clear();
+
+	// Records that cell is held by the node in slot
+	void insert(int cell, int slot);
+
+	// Returns the slot of the node holding cell, or -1 if the current search hasn't reached it
+	int find(int cell) const;
+
+	// Getters
+	bool contains(int cell) const;
+	int getCellCount() const;
+};
@@ -0,0 +1,78 @@
+#include "passabilityBitmap.h"
+
+#include "neighbourhood.h"
+
+passabilityBitmap::passabilityBitmap(int width, int height) : width{ width }, height{ height }
+{
+	// +2 for the padding bit on each side
+	rowWords = (width + 2 + 63) / 64;
+	rows.assign(rowWords * (height + 2), 0);
+
+	// Block the padding so neighbours outside of the map read as blocked
+	for (int x = -1; x <= width; x++)
+	{
+		setBlocked(x, -1, true);
+		setBlocked(x, height, true);
+	}
+
+	for (int y = 0; y < height; y++)
+	{
+		setBlocked(-1, y, true);
+		setBlocked(width, y, true);
+	}
+}
+
+void
+passabilityBitmap::setBlocked(int x, int y, bool blocked)
+{
+	int bit = x + 1;
+	uint64_t& word = rows[(y + 1) * rowWords + (bit >> 6)];
+	uint64_t mask = uint64_t(1) << (bit & 63);
+	if (blocked)
+		word |= mask;
+	else
+		word &= ~mask;
+}
+
+bool
+passabilityBitmap::isBlocked(int x, int y) const
+{
+	if (x < 0 || y < 0 || x >= width || y >= height)
+		return true;
+
+	int bit = x + 1;
+	return (rows[(y + 1) * rowWords + (bit >> 6)] >> (bit & 63)) & 1;
+}
+
+int
+passabilityBitmap::getWidth() const
+{
+	return width;
+}
+
+int
+passabilityBitmap::getHeight() const
+{
+	return height;
+}
+
+unsigned int
+passabilityBitmap::neighbourMask(int x, int y) const
+{
+	return neighbourMaskFromRows(readThree(x, y - 1), readThree(x, y), readThree(x, y + 1));
+}
+
+unsigned int
+passabilityBitmap::readThree(int x, int y) const
+{
+	// x - 1 in the map is bit x in the padded row
+	const uint64_t* row = &rows[(y + 1) * rowWords];
+	int bit = x & 63;
+	uint64_t value = row[x >> 6] >> bit;
+
+	// The three bits straddle two words
+	if (bit > 61)
+		value |= row[(x >> 6) + 1] << (64 - bit);
+
+	return static_cast<unsigned int>(value & 7);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+/*
+	One bit per cell passability map
+
+	Cells only need a single bit to say whether they can be crossed, so packing them into 64-bit words lets us
+	answer which of a cell's eight neighbours are free with three word reads instead of touching cell structs.
+	Every row is padded with a blocked bit on both sides ( and there is a blocked row above and below the map ) so
+	neighbour lookups never need bounds checks.
+
+	A set bit means the cell is BLOCKED.
+*/
+
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Index of the lowest set bit, v must not be 0
+inline int
+bitCountTrailingZeros(uint64_t v)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long i;
+	_BitScanForward64(&i, v);
+	return int(i);
+#elif defined(_MSC_VER)
+	unsigned long i;
+	if (_BitScanForward(&i, static_cast<unsigned long>(v)))
+		return int(i);
+	_BitScanForward(&i, static_cast<unsigned long>(v >> 32));
+	return int(i) + 32;
+#else
+	return __builtin_ctzll(v);
+#endif
+}
+
+class passabilityBitmap {
+/// Variables
+private:
+	int width, height;
+
+	// Words per padded row of the map
+	int rowWords;
+
+	std::vector<uint64_t> rows;
+
+/// Functions & Methods
+public:
+	// Constructor, every cell starts out passable
+	passabilityBitmap(int width, int height);
+
+	// Setters
+	void setBlocked(int x, int y, bool blocked);
+
+	// Getters, anything outside of the map counts as blocked
+	bool isBlocked(int x, int y) const;
+	int getWidth() const;
+	int getHeight() const;
+
+	// Returns a byte with bit i set when the i-th neighbour is passable, neighbours are ordered
+	// NW, N, NE, W, E, SW, S, SE which is the same order as the grid's adj offsets
+	unsigned int neighbourMask(int x, int y) const;
+
+private:
+	// Returns the blocked bits of x - 1, x and x + 1 in row y
+	unsigned int readThree(int x, int y) const;
+};
@@ -0,0 +1,160 @@
+#include "pathCache.h"
+
+#include <algorithm>
+#include <iterator>
+
+// Rough per-entry overhead of the list and hash table nodes, so the budget isn't only counting path data
+#define ENTRY_OVERHEAD (sizeof(void*) * 6)
+
+size_t
+pathCache::keyHash::operator()(const key& k) const
+{
+	uint64_t h = uint64_t(uint32_t(k.start)) * 0x9E3779B97F4A7C15ull;
+	h ^= uint64_t(uint32_t(k.goal)) + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2);
+	h ^= uint64_t(uint32_t(k.mode)) + 0x85EBCA77C2B2AE63ull + (h << 6) + (h >> 2);
+	return size_t(h);
+}
+
+pathCache::pathCache(size_t memoryBudget, int width, int height) : width{ width }, height{ height }, memoryBudget{ memoryBudget }
+{
+}
+
+bool
+pathCache::lookup(int start, int goal, int mode, std::vector<int>& path, float& cost)
+{
+	auto found = lookupTable.find(key{ start, goal, mode });
+	if (found == lookupTable.end())
+	{
+		stats.misses++;
+		return false;
+	}
+
+	// Move the entry to the front since it was just used
+	entries.splice(entries.begin(), entries, found->second);
+
+	path = found->second->path;
+	cost = found->second->cost;
+	stats.hits++;
+	return true;
+}
+
+void
+pathCache::store(int start, int goal, int mode, const std::vector<int>& path, float cost, const std::vector<int>& expanded)
+{
+	key k{ start, goal, mode };
+	auto found = lookupTable.find(k);
+	if (found != lookupTable.end())
+		evict(found->second);
+
+	entry e;
+	e.k = k;
+	e.path = path;
+	e.cost = cost;
+	e.regions[0] = e.regions[1] = 0;
+	e.bytes = sizeof(entry) + ENTRY_OVERHEAD + path.size() * sizeof(int);
+
+	if (e.bytes > memoryBudget)
+		return;
+
+	// An expanded cell had its 8 neighbours read, which can spill into the regions around it
+	for (int index : expanded)
+	{
+		int x = index % width;
+		int y = index / width;
+		int firstX = std::max(x - 1, 0) / REGION_SIZE, lastX = std::min(x + 1, width - 1) / REGION_SIZE;
+		int firstY = std::max(y - 1, 0) / REGION_SIZE, lastY = std::min(y + 1, height - 1) / REGION_SIZE;
+
+		for (int ry = firstY; ry <= lastY; ry++)
+			for (int rx = firstX; rx <= lastX; rx++)
+				addRegion(e.regions, getRegion(rx * REGION_SIZE, ry * REGION_SIZE));
+	}
+
+	while (memoryUsed + e.bytes > memoryBudget && !entries.empty())
+	{
+		evict(std::prev(entries.end()));
+		stats.evictions++;
+	}
+
+	memoryUsed += e.bytes;
+	entries.push_front(e);
+	lookupTable[k] = entries.begin();
+}
+
+void
+pathCache::invalidateCell(int index)
+{
+	int region = getRegion(index % width, index / width);
+
+	for (auto it = entries.begin(); it != entries.end();)
+	{
+		auto next = std::next(it);
+		if (hasRegion(it->regions, region))
+		{
+			evict(it);
+			stats.invalidations++;
+		}
+		it = next;
+	}
+}
+
+void
+pathCache::invalidateAll()
+{
+	stats.invalidations += entries.size();
+	clear();
+}
+
+void
+pathCache::clear()
+{
+	entries.clear();
+	lookupTable.clear();
+	memoryUsed = 0;
+}
+
+const pathCacheStats&
+pathCache::getStats() const
+{
+	return stats;
+}
+
+size_t
+pathCache::getMemoryUsed() const
+{
+	return memoryUsed;
+}
+
+int
+pathCache::getRegion(int x, int y) const
+{
+	int regionsPerRow = (width + REGION_SIZE - 1) / REGION_SIZE;
+	return x / REGION_SIZE + (y / REGION_SIZE) * regionsPerRow;
+}
+
+void
+pathCache::addRegion(uint64_t* regions, int region) const
+{
+	// Two hashes into a 128 bit filter
+	uint32_t h = uint32_t(region) * 0x9E3779B1u;
+	int a = (h >> 25) & 127;
+	int b = (h >> 18) & 127;
+	regions[a >> 6] |= uint64_t(1) << (a & 63);
+	regions[b >> 6] |= uint64_t(1) << (b & 63);
+}
+
+bool
+pathCache::hasRegion(const uint64_t* regions, int region) const
+{
+	uint32_t h = uint32_t(region) * 0x9E3779B1u;
+	int a = (h >> 25) & 127;
+	int b = (h >> 18) & 127;
+	return ((regions[a >> 6] >> (a & 63)) & 1) && ((regions[b >> 6] >> (b & 63)) & 1);
+}
+
+void
+pathCache::evict(std::list<entry>::iterator it)
+{
+	memoryUsed -= it->bytes;
+	lookupTable.erase(it->k);
+	entries.erase(it);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+/*
+	LRU cache of finished searches
+
+	The same spawn points tend to route to the same objectives over and over, so results are kept keyed on
+	( start, goal, search mode ) until the memory budget runs out, at which point the least recently used go first.
+
+	A cached result stays valid as long as nothing the search looked at has changed. Every entry remembers which
+	regions ( REGION_SIZE x REGION_SIZE blocks of cells ) it read passability from in a small bloom filter, and editing
+	a cell only evicts the entries whose filter contains that cell's region. That covers the cells on the path as
+	well as every cell that could have made the search choose differently, and a false positive only costs a re-search.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#define REGION_SIZE 4
+
+struct pathCacheStats {
+	unsigned long long hits = 0;
+	unsigned long long misses = 0;
+	unsigned long long evictions = 0;
+	unsigned long long invalidations = 0;
+};
+
+class pathCache {
+/// Variables
+private:
+	struct key {
+		int start;
+		int goal;
+		int mode;
+
+		bool operator==(const key& k) const
+		{
+			return start == k.start && goal == k.goal && mode == k.mode;
+		}
+	};
+
+	struct keyHash {
+		size_t operator()(const key& k) const;
+	};
+
+	struct entry {
+		key k;
+		std::vector<int> path;
+		float cost;
+		uint64_t regions[2];
+		size_t bytes;
+	};
+
+	int width, height;
+	size_t memoryBudget;
+	size_t memoryUsed = 0;
+
+	// Most recently used entries are at the front
+	std::list<entry> entries;
+	std::unordered_map<key, std::list<entry>::iterator, keyHash> lookupTable;
+
+	pathCacheStats stats;
+
+/// Functions & Methods
+public:
+	// Constructor, memoryBudget is in bytes
+	pathCache(size_t memoryBudget, int width, int height);
+
+	// Returns true and fills path and cost if the query has a valid cached result, a cost below 0 means no path exists
+	bool lookup(int start, int goal, int mode, std::vector<int>& path, float& cost);
+
+	// Stores the result of a search
+	// expanded holds every cell the search expanded, the search read the passability of those and their neighbours
+	void store(int start, int goal, int mode, const std::vector<int>& path, float cost, const std::vector<int>& expanded);
+
+	// Has to be called whenever the passability of a cell changes
+	void invalidateCell(int index);
+
+	// Evicts every entry, for when the cached results may depend on cells their searches never looked at
+	void invalidateAll();
+
+	void clear();
+
+	// Getters
+	const pathCacheStats& getStats() const;
+	size_t getMemoryUsed() const;
+
+private:
+	int getRegion(int x, int y) const;
+	void addRegion(uint64_t* regions, int region) const;
+	bool hasRegion(const uint64_t* regions, int region) const;
+
+	void evict(std::list<entry>::iterator it);
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+/*
+	64-bit path hash
+
+	FNV-1a over the cell indices of a path, fed in one byte at a time from the least significant end so the value
+	doesn't depend on the byte order of the machine. Two searches that return the same cells in the same order give the
+	same hash, which lets replay and regression tools compare results across builds and thread counts with one number.
+	No path at all hashes to the FNV offset basis.
+*/
+
+#include <cstdint>
+
+#define PATH_HASH_OFFSET 14695981039346656037ull
+#define PATH_HASH_PRIME 1099511628211ull
+
+inline uint64_t
+hashPath(const int* cells, int count)
+{
+	uint64_t hash = PATH_HASH_OFFSET;
+	for (int i = 0; i < count; i++)
+	{
+		uint32_t cell = uint32_t(cells[i]);
+		for (int b = 0; b < 4; b++)
+		{
+			hash ^= (cell >> (b * 8)) & 0xFF;
+			hash *= PATH_HASH_PRIME;
+		}
+	}
+
+	return hash;
+}
@@ -0,0 +1,179 @@
+#include "pathTreeCache.h"
+
+#include "distanceField.h"
+#include "neighbourhood.h"
+
+#include <algorithm>
+
+// Nibble values, 0 to 7 are directions in the same order as the grid's adj offsets
+#define TREE_ROOT 8
+#define TREE_UNREACHABLE 15
+
+// Goals whose queries are counted at once, past this every count is halved and the goals left at 0 are forgotten
+#define MAX_COUNTED_GOALS 4096
+
+pathTreeCache::pathTreeCache(size_t memoryBudget, int hotGoalQueries, int width, int height) : width{ width }, height{ height }, memoryBudget{ memoryBudget }, hotGoalQueries{ hotGoalQueries }
+{
+}
+
+bool
+pathTreeCache::recordQuery(int goal)
+{
+	int queries = ++goalQueries[goal];
+
+	// A stream of one-off goals would otherwise grow the counts forever, halving keeps the goals asked for recently and often
+	if (goalQueries.size() > MAX_COUNTED_GOALS)
+	{
+		for (auto it = goalQueries.begin(); it != goalQueries.end();)
+		{
+			it->second /= 2;
+			if (it->second == 0)
+				it = goalQueries.erase(it);
+			else
+				++it;
+		}
+	}
+
+	if (queries < hotGoalQueries)
+		return false;
+
+	for (const tree& t : trees)
+		if (t.goal == goal)
+			return false;
+
+	// Don't bother if a single tree could never fit
+	return getTreeBytes() <= memoryBudget;
+}
+
+void
+pathTreeCache::build(int goal, const distanceField& field)
+{
+	tree t;
+	t.goal = goal;
+	t.parents.assign((width * height + 1) / 2, uint8_t(TREE_UNREACHABLE | (TREE_UNREACHABLE << 4)));
+
+	for (int y = 0; y < height; y++)
+		for (int x = 0; x < width; x++)
+		{
+			int index = x + y * width;
+			float distance = field.getDistance(index);
+
+			int nibble = TREE_UNREACHABLE;
+			if (index == goal)
+				nibble = TREE_ROOT;
+			else if (distance != distanceField::UNREACHABLE)
+			{
+				// The parent is whichever neighbour the distance came through, the lowest direction wins on ties ( see tieBreaking.h )
+				float best = distanceField::UNREACHABLE;
+				for (int i = 0; i < 8; i++)
+				{
+					int nx = x + neighbourDx[i];
+					int ny = y + neighbourDy[i];
+					if (nx < 0 || ny < 0 || nx >= width || ny >= height)
+						continue;
+
+					float through = field.getDistance(nx + ny * width) + neighbourStepCost(i);
+					if (through < best)
+					{
+						best = through;
+						nibble = i;
+					}
+				}
+			}
+
+			uint8_t& packed = t.parents[index >> 1];
+			int shift = (index & 1) * 4;
+			packed = uint8_t((packed & ~(0xF << shift)) | (nibble << shift));
+		}
+
+	trees.push_front(t);
+	stats.built++;
+	trim();
+}
+
+bool
+pathTreeCache::lookup(int start, int goal, std::vector<int>& path, float& cost)
+{
+	auto found = std::find_if(trees.begin(), trees.end(), [goal](const tree& t) { return t.goal == goal; });
+	if (found == trees.end())
+		return false;
+
+	trees.splice(trees.begin(), trees, found);
+	stats.hits++;
+
+	path.clear();
+	cost = 0;
+
+	int index = start;
+	while (true)
+	{
+		int nibble = (found->parents[index >> 1] >> ((index & 1) * 4)) & 0xF;
+		if (nibble == TREE_ROOT)
+			break;
+
+		if (nibble == TREE_UNREACHABLE)
+		{
+			path.clear();
+			cost = -1;
+			return true;
+		}
+
+		index += neighbourDx[nibble] + neighbourDy[nibble] * width;
+		path.push_back(index);
+	}
+
+	// We walked from the start to the goal, the grid keeps paths the other way around
+	std::reverse(path.begin(), path.end());
+
+	// The cost is summed from the goal outwards, the same order a search from the goal adds it up in, so both agree to the bit
+	for (size_t i = 0; i < path.size(); i++)
+	{
+		int from = path[i];
+		int to = i + 1 < path.size() ? path[i + 1] : start;
+		cost += from % width != to % width && from / width != to / width ? NEIGHBOUR_DIAGONAL_COST : NEIGHBOUR_STRAIGHT_COST;
+	}
+
+	return true;
+}
+
+void
+pathTreeCache::clear()
+{
+	trees.clear();
+	goalQueries.clear();
+}
+
+void
+pathTreeCache::setMemoryBudget(size_t bytes)
+{
+	memoryBudget = bytes;
+	trim();
+}
+
+const pathTreeStats&
+pathTreeCache::getStats() const
+{
+	return stats;
+}
+
+size_t
+pathTreeCache::getMemoryUsed() const
+{
+	return trees.size() * getTreeBytes();
+}
+
+size_t
+pathTreeCache::getTreeBytes() const
+{
+	return sizeof(tree) + (width * height + 1) / 2;
+}
+
+void
+pathTreeCache::trim()
+{
+	while (!trees.empty() && getMemoryUsed() > memoryBudget)
+	{
+		trees.pop_back();
+		stats.evictions++;
+	}
+}
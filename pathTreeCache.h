@@ -0,0 +1,79 @@
+#pragma once
+
+/*
+	Retained shortest-path trees for frequently requested goals
+
+	A single search from a goal ( the grid is undirected, so searching outwards from the goal is the same as searching
+	towards it ) already knows the best route from every cell. Once a goal has been asked for often enough we build that
+	tree with the distance field and keep only what is needed to walk it: the direction to the parent of every cell,
+	packed into 4 bits. Any later query for that goal is then answered by following parent directions from the start,
+	without searching at all.
+
+	Trees are kept in least recently used order within a memory budget and have to be dropped whenever the grid is edited.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+class distanceField;
+
+struct pathTreeStats {
+	unsigned long long hits = 0;
+	unsigned long long built = 0;
+	unsigned long long evictions = 0;
+};
+
+class pathTreeCache {
+/// Variables
+private:
+	struct tree {
+		int goal;
+
+		// Two cells per byte, see the TREE_* values in the source for what a nibble holds
+		std::vector<uint8_t> parents;
+	};
+
+	int width, height;
+	size_t memoryBudget;
+	int hotGoalQueries;
+
+	// Most recently used trees are at the front
+	std::list<tree> trees;
+
+	// How often each goal was asked for, kept to a bounded number of goals ( see recordQuery )
+	std::unordered_map<int, int> goalQueries;
+
+	pathTreeStats stats;
+
+/// Functions & Methods
+public:
+	// Constructor, memoryBudget is in bytes and hotGoalQueries is how often a goal has to be asked for before it gets a tree
+	pathTreeCache(size_t memoryBudget, int hotGoalQueries, int width, int height);
+
+	// Counts a query towards goal, returns true if goal is now hot but doesn't have a tree yet
+	bool recordQuery(int goal);
+
+	// Builds and retains the tree of goal from a distance field computed from goal
+	void build(int goal, const distanceField& field);
+
+	// Returns true if a tree for goal exists, then path holds the cells from goal back to ( but excluding ) start
+	// and cost its length, a cost below 0 means start can't reach goal
+	bool lookup(int start, int goal, std::vector<int>& path, float& cost);
+
+	// Drops every tree and forgets how often goals were asked for, this has to happen whenever the grid changes
+	void clear();
+
+	// Setters
+	void setMemoryBudget(size_t bytes);
+
+	// Getters
+	const pathTreeStats& getStats() const;
+	size_t getMemoryUsed() const;
+
+private:
+	size_t getTreeBytes() const;
+	void trim();
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+/*
+	Tie-breaking policies
+
+	When several open nodes share the lowest f cost, one of them has to be expanded first. Leaving that to whatever order
+	nodes happened to be stored in makes the work a search does depend on implementation details, so searches take one
+	of these as a template argument instead and always pick the same node for the same map and query.
+
+		preferDeeperNodes - higher g first ( further from where the search started ), then the lower cell index, the order is total
+		firstDiscovered   - whichever node was discovered first
+
+	better( a, b ) returns true when node a should be expanded before node b.
+
+	A policy only changes how many nodes are expanded, not which path comes back. Paths before this rule existed depended on
+	expansion order, so neither policy reproduces them. Every search that has to agree with the grid ( the grid's A*, the
+	path trees and HDA* ) follows one canonical path rule instead:
+
+		- the search runs from the goal to the start, so the parent of a cell is its next step towards the goal
+		- a cell takes a parent that reaches it with a strictly lower g, and is expanded again if it was already
+		- a cell reached with the same g through a parent in a lower direction ( adj order, the one in neighbourhood.h )
+		  takes that parent instead
+		- once the start is expanded, nodes with f up to the start's g plus PATH_TIE_EPSILON are still expanded, since
+		  they can give a cell of the path an equally short parent in a lower direction
+
+	That is the parent a shortest-path tree of the goal picks for every cell, so a query has one answer whether it was
+	searched, cached or read from a tree.
+*/
+
+struct preferDeeperNodes {
+	static bool
+	better(float fA, float gA, int cellA, float fB, float gB, int cellB)
+	{
+		if (fA != fB)
+			return fA < fB;
+		if (gA != gB)
+			return gA > gB;
+		return cellA < cellB;
+	}
+};
+
+struct firstDiscovered {
+	// Nodes are checked in discovery order, so only a strictly lower f may replace the current pick
+	static bool
+	better(float fA, float, int, float fB, float, int)
+	{
+		return fA < fB;
+	}
+};
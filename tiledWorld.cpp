@@ -0,0 +1,623 @@
+#include "tiledWorld.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <queue>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "neighbourhood.h"
+
+#define WORLD_MAGIC "TWLD"
+#define WORLD_VERSION 1
+
+// Low two bits of a summary say what the tile holds
+#define TILE_OPEN 0
+#define TILE_BLOCKED 1
+#define TILE_MIXED 2
+#define TILE_KIND_MASK 3
+
+// The rest say which neighbours can be reached from the tile, the other four directions are stored by the neighbour
+#define TILE_LINK_EAST (1 << 2)
+#define TILE_LINK_SOUTH (1 << 3)
+#define TILE_LINK_SOUTH_EAST (1 << 4)
+#define TILE_LINK_SOUTH_WEST (1 << 5)
+
+// How often the corridor is widened before the search is allowed everywhere
+#define MAX_WIDENINGS 2
+
+// Cell search parents, 0 to 7 are the direction the cell was reached in
+#define SEARCH_START 8
+#define SEARCH_UNVISITED 9
+#define SEARCH_CLOSED 0x80
+
+static float
+octile(long long dx, long long dy)
+{
+	dx = dx < 0 ? -dx : dx;
+	dy = dy < 0 ? -dy : dy;
+	return float(std::max(dx, dy)) + (NEIGHBOUR_DIAGONAL_COST - NEIGHBOUR_STRAIGHT_COST) * float(std::min(dx, dy));
+}
+
+bool
+tiledWorld::write(const std::string& path, long long width, long long height, int tileSize, const std::function<bool(long long, long long)>& isBlocked)
+{
+	FILE* index = fopen((path + ".index").c_str(), "wb");
+	FILE* tiles = fopen((path + ".tiles").c_str(), "wb");
+	if (index == nullptr || tiles == nullptr)
+	{
+		if (index)
+			fclose(index);
+		if (tiles)
+			fclose(tiles);
+		return false;
+	}
+
+	int tilesX = int((width + tileSize - 1) / tileSize);
+	int tilesY = int((height + tileSize - 1) / tileSize);
+	int wordsPerRow = (tileSize + 63) / 64;
+
+	int version = WORLD_VERSION;
+	fwrite(WORLD_MAGIC, 1, 4, index);
+	fwrite(&version, sizeof(version), 1, index);
+	fwrite(&width, sizeof(width), 1, index);
+	fwrite(&height, sizeof(height), 1, index);
+	fwrite(&tileSize, sizeof(tileSize), 1, index);
+
+	auto blockedAt = [&](long long x, long long y) {
+		return x < 0 || y < 0 || x >= width || y >= height || isBlocked(x, y);
+	};
+
+	std::vector<uint64_t> bits(size_t(wordsPerRow) * tileSize);
+	for (int ty = 0; ty < tilesY; ty++)
+		for (int tx = 0; tx < tilesX; tx++)
+		{
+			long long firstX = (long long)tx * tileSize, firstY = (long long)ty * tileSize;
+			long long lastX = std::min(firstX + tileSize, width) - 1, lastY = std::min(firstY + tileSize, height) - 1;
+
+			std::fill(bits.begin(), bits.end(), 0);
+			long long blockedCount = 0;
+			for (int y = 0; y < tileSize; y++)
+				for (int x = 0; x < tileSize; x++)
+					if (blockedAt(firstX + x, firstY + y))
+					{
+						bits[y * wordsPerRow + x / 64] |= uint64_t(1) << (x % 64);
+						blockedCount++;
+					}
+
+			uint8_t summary = TILE_MIXED;
+			if (blockedCount == 0)
+				summary = TILE_OPEN;
+			else if (blockedCount == (long long)tileSize * tileSize)
+				summary = TILE_BLOCKED;
+
+			// Tiles are linked when at least one cell pair across their border is passable on both sides
+			for (long long y = firstY; y <= lastY && !(summary & TILE_LINK_EAST); y++)
+				if (!blockedAt(lastX, y) && (!blockedAt(lastX + 1, y - 1) || !blockedAt(lastX + 1, y) || !blockedAt(lastX + 1, y + 1)))
+					summary |= TILE_LINK_EAST;
+
+			for (long long x = firstX; x <= lastX && !(summary & TILE_LINK_SOUTH); x++)
+				if (!blockedAt(x, lastY) && (!blockedAt(x - 1, lastY + 1) || !blockedAt(x, lastY + 1) || !blockedAt(x + 1, lastY + 1)))
+					summary |= TILE_LINK_SOUTH;
+
+			if (!blockedAt(lastX, lastY) && !blockedAt(lastX + 1, lastY + 1))
+				summary |= TILE_LINK_SOUTH_EAST;
+
+			if (!blockedAt(firstX, lastY) && !blockedAt(firstX - 1, lastY + 1))
+				summary |= TILE_LINK_SOUTH_WEST;
+
+			fwrite(&summary, 1, 1, index);
+			fwrite(bits.data(), sizeof(uint64_t), bits.size(), tiles);
+		}
+
+	bool ok = !ferror(index) && !ferror(tiles);
+	fclose(index);
+	fclose(tiles);
+	return ok;
+}
+
+tiledWorld::tiledWorld(const std::string& path, size_t maxResidentTiles) : maxResidentTiles{ std::max<size_t>(maxResidentTiles, 1) }
+{
+	FILE* index = fopen((path + ".index").c_str(), "rb");
+	if (index == nullptr)
+	{
+		printf("ERROR::Tiled world index %s.index could not be opened\n", path.c_str());
+		return;
+	}
+
+	char magic[4];
+	int version = 0;
+	bool ok = fread(magic, 1, 4, index) == 4 && memcmp(magic, WORLD_MAGIC, 4) == 0;
+	ok = ok && fread(&version, sizeof(version), 1, index) == 1 && version == WORLD_VERSION;
+	ok = ok && fread(&width, sizeof(width), 1, index) == 1;
+	ok = ok && fread(&height, sizeof(height), 1, index) == 1;
+	ok = ok && fread(&tileSize, sizeof(tileSize), 1, index) == 1 && tileSize > 0;
+
+	if (ok)
+	{
+		tilesX = int((width + tileSize - 1) / tileSize);
+		tilesY = int((height + tileSize - 1) / tileSize);
+		wordsPerRow = (tileSize + 63) / 64;
+		tileBytes = size_t(wordsPerRow) * tileSize * sizeof(uint64_t);
+
+		summaries.resize(size_t(tilesX) * tilesY);
+		ok = fread(summaries.data(), 1, summaries.size(), index) == summaries.size();
+	}
+	fclose(index);
+
+	if (!ok)
+	{
+		printf("ERROR::Tiled world index %s.index is not valid\n", path.c_str());
+		return;
+	}
+
+	std::string tilePath = path + ".tiles";
+#ifdef _WIN32
+	HANDLE f = CreateFileA(tilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (f == INVALID_HANDLE_VALUE)
+	{
+		printf("ERROR::Tiled world tiles %s could not be opened\n", tilePath.c_str());
+		return;
+	}
+
+	file = f;
+	mapping = CreateFileMappingA(f, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+	{
+		printf("ERROR::Tiled world tiles %s could not be mapped\n", tilePath.c_str());
+		return;
+	}
+
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	mapGranularity = info.dwAllocationGranularity;
+#else
+	descriptor = open(tilePath.c_str(), O_RDONLY);
+	if (descriptor < 0)
+	{
+		printf("ERROR::Tiled world tiles %s could not be opened\n", tilePath.c_str());
+		return;
+	}
+
+	mapGranularity = size_t(sysconf(_SC_PAGESIZE));
+#endif
+
+	corridor.assign(summaries.size(), 0);
+	searchTiles = nodeIndex(int(summaries.size()));
+	opened = true;
+}
+
+tiledWorld::~tiledWorld()
+{
+	for (residentTile& t : resident)
+		unmapTile(t);
+
+#ifdef _WIN32
+	if (mapping)
+		CloseHandle(mapping);
+	if (file)
+		CloseHandle(file);
+#else
+	if (descriptor >= 0)
+		close(descriptor);
+#endif
+}
+
+bool
+tiledWorld::findPath(long long start, long long goal, std::vector<long long>& path)
+{
+	lastQuery = tiledQueryStats();
+	path.clear();
+
+	bool found = false;
+	long long startX = start % width, startY = start / width;
+	long long goalX = goal % width, goalY = goal / width;
+
+	if (opened && !isBlocked(startX, startY) && !isBlocked(goalX, goalY))
+	{
+		int startTile = int(startX / tileSize + (startY / tileSize) * tilesX);
+		int goalTile = int(goalX / tileSize + (goalY / tileSize) * tilesX);
+
+		// No route between the tiles means no route between the cells
+		// The corridor bounds how many tiles the searches inside it can reach
+		if (findCorridor(startTile, goalTile))
+		{
+			found = searchCells(start, goal, path, summaries.size());
+			for (int i = 0; i < MAX_WIDENINGS && !found; i++)
+			{
+				widenCorridor();
+				lastQuery.widenings++;
+				found = searchCells(start, goal, path, summaries.size());
+			}
+
+			// Last resort, let the search go anywhere, but no further than the resident set could hold
+			// Otherwise a goal the tile graph wrongly connects would make it explore everything it can reach
+			if (!found)
+			{
+				corridorStamp++;
+				std::fill(corridor.begin(), corridor.end(), corridorStamp);
+				lastQuery.widenings++;
+				found = searchCells(start, goal, path, maxResidentTiles);
+			}
+		}
+	}
+
+	countQuery();
+	return found;
+}
+
+bool
+tiledWorld::findShortestPath(long long start, long long goal, std::vector<long long>& path, size_t maxTiles)
+{
+	lastQuery = tiledQueryStats();
+	path.clear();
+
+	bool found = false;
+	if (opened && !isBlocked(start % width, start / width) && !isBlocked(goal % width, goal / width))
+	{
+		corridorStamp++;
+		std::fill(corridor.begin(), corridor.end(), corridorStamp);
+		found = searchCells(start, goal, path, maxTiles);
+	}
+
+	countQuery();
+	return found;
+}
+
+bool
+tiledWorld::isOpen() const
+{
+	return opened;
+}
+
+bool
+tiledWorld::isBlocked(long long x, long long y)
+{
+	if (x < 0 || y < 0 || x >= width || y >= height)
+		return true;
+
+	int tile = int(x / tileSize + (y / tileSize) * tilesX);
+	int kind = summaries[tile] & TILE_KIND_MASK;
+	if (kind != TILE_MIXED)
+		return kind == TILE_BLOCKED;
+
+	if (tile != lastTile)
+	{
+		lastBits = fetchTile(tile);
+		lastTile = tile;
+	}
+
+	int localX = int(x % tileSize), localY = int(y % tileSize);
+	return (lastBits[localY * wordsPerRow + localX / 64] >> (localX % 64)) & 1;
+}
+
+long long
+tiledWorld::getWidth() const
+{
+	return width;
+}
+
+long long
+tiledWorld::getHeight() const
+{
+	return height;
+}
+
+size_t
+tiledWorld::getResidentCount() const
+{
+	return resident.size();
+}
+
+const tiledQueryStats&
+tiledWorld::getLastQueryStats() const
+{
+	return lastQuery;
+}
+
+const tiledQueryStats&
+tiledWorld::getTotalStats() const
+{
+	return totals;
+}
+
+const uint64_t*
+tiledWorld::fetchTile(int tile)
+{
+	auto found = residentLookup.find(tile);
+	if (found != residentLookup.end())
+	{
+		resident.splice(resident.begin(), resident, found->second);
+		return found->second->bits;
+	}
+
+	if (resident.size() >= maxResidentTiles)
+	{
+		residentTile& oldest = resident.back();
+		if (oldest.tile == lastTile)
+			lastTile = -1;
+
+		unmapTile(oldest);
+		residentLookup.erase(oldest.tile);
+		resident.pop_back();
+	}
+
+	// Views have to start on the mapping granularity, so we map from the boundary before the tile
+	unsigned long long offset = (unsigned long long)tile * tileBytes;
+	unsigned long long aligned = offset - offset % mapGranularity;
+	size_t viewBytes = size_t(offset - aligned) + tileBytes;
+
+#ifdef _WIN32
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, DWORD(aligned >> 32), DWORD(aligned & 0xFFFFFFFF), viewBytes);
+#else
+	void* view = mmap(nullptr, viewBytes, PROT_READ, MAP_SHARED, descriptor, off_t(aligned));
+	if (view == MAP_FAILED)
+		view = nullptr;
+#endif
+
+	if (view == nullptr)
+	{
+		// Better to treat the tile as blocked than to fall over
+		printf("ERROR::Tile %i could not be mapped\n", tile);
+		if (unmappedTile.empty())
+			unmappedTile.assign(size_t(wordsPerRow) * tileSize, ~uint64_t(0));
+		return unmappedTile.data();
+	}
+
+	lastQuery.tileFaults++;
+	lastQuery.ioBytes += tileBytes;
+
+	residentTile t{ tile, view, viewBytes, reinterpret_cast<const uint64_t*>(static_cast<const char*>(view) + (offset - aligned)) };
+	resident.push_front(t);
+	residentLookup[tile] = resident.begin();
+	return t.bits;
+}
+
+void
+tiledWorld::unmapTile(residentTile& t)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(t.view);
+#else
+	munmap(t.view, t.viewBytes);
+#endif
+}
+
+bool
+tiledWorld::findCorridor(int startTile, int goalTile)
+{
+	typedef std::pair<float, int> entry;
+	std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+
+	std::vector<float> gCost(summaries.size(), INFINITY);
+	std::vector<int> parent(summaries.size(), -1);
+
+	auto tileDistance = [this](int a, int b) {
+		return octile(a % tilesX - b % tilesX, a / tilesX - b / tilesX) * float(tileSize);
+	};
+
+	gCost[startTile] = 0;
+	open.push(entry(tileDistance(startTile, goalTile), startTile));
+
+	bool found = false;
+	while (!open.empty())
+	{
+		entry e = open.top();
+		open.pop();
+
+		int tile = e.second;
+		if (tile == goalTile)
+		{
+			found = true;
+			break;
+		}
+
+		if (e.first > gCost[tile] + tileDistance(tile, goalTile))
+			continue;
+
+		lastQuery.abstractExpansions++;
+
+		for (int i = 0; i < 8; i++)
+		{
+			int nx = tile % tilesX + neighbourDx[i];
+			int ny = tile / tilesX + neighbourDy[i];
+			if (nx < 0 || ny < 0 || nx >= tilesX || ny >= tilesY || !tilesConnect(tile, neighbourDx[i], neighbourDy[i]))
+				continue;
+
+			int next = nx + ny * tilesX;
+			float g = gCost[tile] + neighbourStepCost(i) * float(tileSize);
+			if (g < gCost[next])
+			{
+				gCost[next] = g;
+				parent[next] = tile;
+				open.push(entry(g + tileDistance(next, goalTile), next));
+			}
+		}
+	}
+
+	if (!found)
+		return false;
+
+	// The route and a ring of tiles around it make up the corridor
+	corridorStamp++;
+	for (int tile = goalTile; tile != -1; tile = parent[tile])
+		corridor[tile] = corridorStamp;
+	widenCorridor();
+
+	return true;
+}
+
+void
+tiledWorld::widenCorridor()
+{
+	uint32_t previous = corridorStamp++;
+
+	lastQuery.corridorTiles = 0;
+	for (int tile = 0; tile < int(corridor.size()); tile++)
+	{
+		if (corridor[tile] != previous)
+			continue;
+
+		for (int dy = -1; dy <= 1; dy++)
+			for (int dx = -1; dx <= 1; dx++)
+			{
+				int nx = tile % tilesX + dx;
+				int ny = tile / tilesX + dy;
+				if (nx < 0 || ny < 0 || nx >= tilesX || ny >= tilesY)
+					continue;
+
+				int next = nx + ny * tilesX;
+				if (corridor[next] == previous)
+					continue;
+
+				if (corridor[next] != corridorStamp)
+					lastQuery.corridorTiles++;
+				corridor[next] = corridorStamp;
+			}
+
+		corridor[tile] = corridorStamp;
+		lastQuery.corridorTiles++;
+	}
+}
+
+bool
+tiledWorld::searchCells(long long start, long long goal, std::vector<long long>& path, size_t maxTiles)
+{
+	struct openEntry {
+		float fCost;
+		float gCost;
+		long long cell;
+
+		bool operator<(const openEntry& o) const
+		{
+			if (fCost != o.fCost)
+				return fCost > o.fCost;
+			return gCost < o.gCost;
+		}
+	};
+
+	// The map is far too large for dense per-cell arrays, so every tile the search touches gets its own block of them
+	searchTiles.clear();
+	searchG.clear();
+	searchParent.clear();
+	int tileCells = tileSize * tileSize;
+
+	auto slotOf = [&](long long x, long long y) {
+		int tile = int(x / tileSize + (y / tileSize) * tilesX);
+		int block = searchTiles.find(tile);
+		if (block < 0)
+		{
+			block = int(searchG.size() / tileCells);
+			searchTiles.insert(tile, block);
+			searchG.resize(searchG.size() + tileCells, INFINITY);
+			searchParent.resize(searchParent.size() + tileCells, uint8_t(SEARCH_UNVISITED));
+		}
+
+		return size_t(block) * tileCells + size_t(y % tileSize) * tileSize + size_t(x % tileSize);
+	};
+
+	std::priority_queue<openEntry> open;
+
+	long long goalX = goal % width, goalY = goal / width;
+	size_t startSlot = slotOf(start % width, start / width);
+	searchG[startSlot] = 0;
+	searchParent[startSlot] = SEARCH_START;
+	open.push(openEntry{ octile(start % width - goalX, start / width - goalY), 0.f, start });
+
+	while (!open.empty())
+	{
+		openEntry e = open.top();
+		open.pop();
+
+		long long x = e.cell % width, y = e.cell / width;
+		size_t slot = slotOf(x, y);
+		if (e.gCost > searchG[slot] || (searchParent[slot] & SEARCH_CLOSED))
+			continue;
+		searchParent[slot] |= SEARCH_CLOSED;
+
+		if (e.cell == goal)
+		{
+			// Parents are stored as the direction we came from, so walking back means stepping against it
+			long long c = goal;
+			while (true)
+			{
+				path.push_back(c);
+				int parent = searchParent[slotOf(c % width, c / width)] & ~SEARCH_CLOSED;
+				if (parent == SEARCH_START)
+					break;
+				c -= neighbourDx[parent] + neighbourDy[parent] * width;
+			}
+			std::reverse(path.begin(), path.end());
+			return true;
+		}
+
+		lastQuery.expansions++;
+
+		for (int i = 0; i < 8; i++)
+		{
+			long long nx = x + neighbourDx[i], ny = y + neighbourDy[i];
+			if (nx < 0 || ny < 0 || nx >= width || ny >= height)
+				continue;
+
+			int tile = int(nx / tileSize + (ny / tileSize) * tilesX);
+			if (corridor[tile] != corridorStamp || isBlocked(nx, ny))
+				continue;
+
+			// Entering one tile more than allowed ends the search, the caller learns of it through the stats
+			if (!searchTiles.contains(tile) && searchG.size() / tileCells >= maxTiles)
+			{
+				lastQuery.abandoned++;
+				return false;
+			}
+
+			float g = e.gCost + neighbourStepCost(i);
+			size_t next = slotOf(nx, ny);
+			if (g >= searchG[next])
+				continue;
+
+			searchG[next] = g;
+			searchParent[next] = uint8_t(i);
+			open.push(openEntry{ g + octile(nx - goalX, ny - goalY), g, nx + ny * width });
+		}
+	}
+
+	return false;
+}
+
+void
+tiledWorld::countQuery()
+{
+	totals.tileFaults += lastQuery.tileFaults;
+	totals.ioBytes += lastQuery.ioBytes;
+	totals.expansions += lastQuery.expansions;
+	totals.abstractExpansions += lastQuery.abstractExpansions;
+	totals.corridorTiles += lastQuery.corridorTiles;
+	totals.widenings += lastQuery.widenings;
+	totals.abandoned += lastQuery.abandoned;
+}
+
+bool
+tiledWorld::tilesConnect(int from, int dx, int dy) const
+{
+	int x = from % tilesX, y = from / tilesX;
+
+	if (dy == 0)
+		return summaries[dx > 0 ? from : from - 1] & TILE_LINK_EAST;
+	if (dx == 0)
+		return summaries[dy > 0 ? from : from - tilesX] & TILE_LINK_SOUTH;
+
+	// Diagonals are stored by whichever of the two tiles is on top
+	if (dx == dy)
+		return summaries[dy > 0 ? from : (x - 1) + (y - 1) * tilesX] & TILE_LINK_SOUTH_EAST;
+	return summaries[dy > 0 ? from : (x + 1) + (y - 1) * tilesX] & TILE_LINK_SOUTH_WEST;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+/*
+	Streaming tiled world for maps too large to keep in memory
+
+	The world lives on disk as two files. <name>.tiles holds the passability bits of every tileSize x tileSize tile, and
+	<name>.index holds a small header and one summary byte per tile. The summary says whether a tile is completely
+	open, completely blocked or mixed, and whether it connects to its east, south and diagonal neighbours.
+
+	Only the index is read up front. Mixed tiles are memory-mapped when a search first touches them and kept in a
+	least recently used resident set of bounded size. Open and blocked tiles never have to be loaded at all.
+
+	A query first searches the tile graph built from the summaries, which gives a corridor of tiles. The cell level
+	search is then only allowed into that corridor, so tiles away from the route are never faulted in. If the corridor
+	turns out too narrow ( tile level connectivity is only an estimate ) it is widened and the search runs again. As a
+	last resort the search may go anywhere, but it keeps search state for at most as many tiles as may be resident, and
+	gives up once it needs more.
+
+	The path found is the shortest one inside the corridor, which isn't always the shortest one on the map: the tile
+	route is planned on tile distances only, and the corridor is just that route with a ring of tiles around it. Paths
+	that have to leave the corridor to be shortest come back longer, by a few percent on the worlds we tried ( the tiled
+	benchmark reports it ). findShortestPath searches without a corridor when the exact answer is needed, at the cost
+	of touching every tile the search reaches.
+
+	Cells are addressed with 64-bit indices ( x + y * width ) since these maps don't fit in an int.
+*/
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "nodeIndex.h"
+
+struct tiledQueryStats {
+	unsigned long long tileFaults = 0;
+	unsigned long long ioBytes = 0;
+	unsigned long long expansions = 0;
+	unsigned long long abstractExpansions = 0;
+	unsigned long long corridorTiles = 0;
+	unsigned long long widenings = 0;
+
+	// Searches given up because they needed search state for more tiles than they were allowed
+	unsigned long long abandoned = 0;
+};
+
+class tiledWorld {
+/// Variables
+private:
+	struct residentTile {
+		int tile;
+		void* view;
+		size_t viewBytes;
+		const uint64_t* bits;
+	};
+
+	long long width = 0, height = 0;
+	int tileSize = 0;
+	int tilesX = 0, tilesY = 0;
+	int wordsPerRow = 0;
+	size_t tileBytes = 0;
+
+	std::vector<uint8_t> summaries;
+
+	// Most recently used tiles are at the front
+	size_t maxResidentTiles;
+	std::list<residentTile> resident;
+	std::unordered_map<int, std::list<residentTile>::iterator> residentLookup;
+
+	// Stands in, fully blocked, for tiles that could not be mapped
+	std::vector<uint64_t> unmappedTile;
+
+	// Last tile a lookup landed in, most lookups hit the same tile as the one before
+	int lastTile = -1;
+	const uint64_t* lastBits = nullptr;
+
+	// Platform file and mapping handles
+	void* file = nullptr;
+	void* mapping = nullptr;
+	int descriptor = -1;
+	size_t mapGranularity = 0;
+
+	// Stamped tile sets used by the searches
+	std::vector<uint32_t> corridor;
+	uint32_t corridorStamp = 0;
+
+	// Cell search state, one block of tileSize * tileSize cells for every tile the search has touched
+	// searchTiles says which block belongs to a tile, it is sized once the number of tiles is known
+	nodeIndex searchTiles{ 0 };
+	std::vector<float> searchG;
+	std::vector<uint8_t> searchParent;
+
+	tiledQueryStats lastQuery;
+	tiledQueryStats totals;
+
+	bool opened = false;
+
+/// Functions & Methods
+public:
+	// Writes a world to <path>.index and <path>.tiles, isBlocked answers for any cell of the map and may be asked more than once
+	static bool write(const std::string& path, long long width, long long height, int tileSize, const std::function<bool(long long, long long)>& isBlocked);
+
+	// Constructor & Deconstructor, opens a world written by write and keeps at most maxResidentTiles tiles mapped
+	tiledWorld(const std::string& path, size_t maxResidentTiles);
+	~tiledWorld();
+
+	// Searches for a path inside a corridor of tiles, path is filled with the cells from start to goal ( both included )
+	// Returns false if there is none
+	bool findPath(long long start, long long goal, std::vector<long long>& path);
+
+	// Searches for the shortest path with no corridor, giving up ( and returning false ) once it has reached maxTiles tiles
+	bool findShortestPath(long long start, long long goal, std::vector<long long>& path, size_t maxTiles);
+
+	// Getters
+	bool isOpen() const;
+	bool isBlocked(long long x, long long y);
+	long long getWidth() const;
+	long long getHeight() const;
+	size_t getResidentCount() const;
+	const tiledQueryStats& getLastQueryStats() const;
+	const tiledQueryStats& getTotalStats() const;
+
+private:
+	// Returns the bits of a mixed tile, mapping it in if it isn't resident
+	const uint64_t* fetchTile(int tile);
+	void unmapTile(residentTile& t);
+
+	// Tile level search, marks the tiles of the route ( and their neighbours ) in corridor
+	bool findCorridor(int startTile, int goalTile);
+	void widenCorridor();
+
+	// Cell level search inside the corridor, it is abandoned once it would need search state for more than maxTiles tiles
+	bool searchCells(long long start, long long goal, std::vector<long long>& path, size_t maxTiles);
+
+	// Adds the last query to the totals
+	void countQuery();
+
+	bool tilesConnect(int from, int dx, int dy) const;
+};
@@ -0,0 +1,210 @@
+#include "versionedGrid.h"
+
+#include <algorithm>
+
+#include "neighbourhood.h"
+
+gridVersion::gridVersion(int width, int height) : width{ width }, height{ height }
+{
+	tilesX = (width + SNAPSHOT_TILE_SIZE - 1) / SNAPSHOT_TILE_SIZE;
+	tilesY = (height + SNAPSHOT_TILE_SIZE - 1) / SNAPSHOT_TILE_SIZE;
+}
+
+bool
+gridVersion::isBlocked(int x, int y) const
+{
+	if (x < 0 || y < 0 || x >= width || y >= height)
+		return true;
+
+	const gridTile* tile = tiles[x / SNAPSHOT_TILE_SIZE + (y / SNAPSHOT_TILE_SIZE) * tilesX].get();
+	return (tile->rows[y % SNAPSHOT_TILE_SIZE] >> (x % SNAPSHOT_TILE_SIZE)) & 1;
+}
+
+unsigned long long
+gridVersion::getNumber() const
+{
+	return number;
+}
+
+int
+gridVersion::getWidth() const
+{
+	return width;
+}
+
+int
+gridVersion::getHeight() const
+{
+	return height;
+}
+
+unsigned int
+gridVersion::neighbourMask(int x, int y) const
+{
+	return neighbourMaskFromRows(readThree(x, y - 1), readThree(x, y), readThree(x, y + 1));
+}
+
+unsigned int
+gridVersion::readThree(int x, int y) const
+{
+	if (y < 0 || y >= height)
+		return 7;
+
+	// When all three cells sit in the same tile it's a single shift
+	int column = x % SNAPSHOT_TILE_SIZE;
+	if (column > 0 && column < SNAPSHOT_TILE_SIZE - 1 && x + 1 < width)
+	{
+		const gridTile* tile = tiles[x / SNAPSHOT_TILE_SIZE + (y / SNAPSHOT_TILE_SIZE) * tilesX].get();
+		return unsigned(tile->rows[y % SNAPSHOT_TILE_SIZE] >> (column - 1)) & 7;
+	}
+
+	return unsigned(isBlocked(x - 1, y)) | (unsigned(isBlocked(x, y)) << 1) | (unsigned(isBlocked(x + 1, y)) << 2);
+}
+
+versionedGrid::versionedGrid(int width, int height, int readerCount) : width{ width }, height{ height }, readerCount{ readerCount }
+{
+	readers.reset(new readerSlot[readerCount]);
+	liveTiles = std::make_shared<std::atomic<long>>(0);
+
+	// Every tile starts out as the same empty tile, so an untouched map costs one tile
+	std::shared_ptr<std::atomic<long>> counter = liveTiles;
+	counter->fetch_add(1);
+	std::shared_ptr<const gridTile> empty(new gridTile(), [counter](const gridTile* t) { counter->fetch_sub(1); delete t; });
+
+	gridVersion* first = new gridVersion(width, height);
+	first->tiles.assign(first->tilesX * first->tilesY, empty);
+	current.store(first);
+}
+
+versionedGrid::~versionedGrid()
+{
+	// Nobody can be reading anymore at this point
+	delete current.load();
+	delete pending;
+	for (gridVersion* v : retired)
+		delete v;
+}
+
+int
+versionedGrid::acquireReader()
+{
+	for (int i = 0; i < readerCount; i++)
+	{
+		bool expected = false;
+		if (readers[i].taken.compare_exchange_strong(expected, true))
+			return i;
+	}
+
+	return -1;
+}
+
+void
+versionedGrid::releaseReader(int reader)
+{
+	readers[reader].epoch.store(0);
+	readers[reader].taken.store(false);
+}
+
+const gridVersion*
+versionedGrid::pin(int reader)
+{
+	// Announce the epoch before looking at the version, this is what keeps the writer from freeing it under us
+	readers[reader].epoch.store(epoch.load());
+	return current.load();
+}
+
+void
+versionedGrid::unpin(int reader)
+{
+	readers[reader].epoch.store(0);
+}
+
+void
+versionedGrid::setBlocked(int x, int y, bool blocked)
+{
+	if (pending == nullptr)
+	{
+		const gridVersion* published = current.load();
+		pending = new gridVersion(width, height);
+		pending->tiles = published->tiles;
+		pending->number = published->number + 1;
+		pendingOwnsTile.assign(pending->tiles.size(), false);
+	}
+
+	int tileIndex = x / SNAPSHOT_TILE_SIZE + (y / SNAPSHOT_TILE_SIZE) * pending->tilesX;
+
+	// Copy on write, the first edit to a tile in this version gets its own copy
+	if (!pendingOwnsTile[tileIndex])
+	{
+		std::shared_ptr<std::atomic<long>> counter = liveTiles;
+		counter->fetch_add(1);
+		pending->tiles[tileIndex] = std::shared_ptr<const gridTile>(new gridTile(*pending->tiles[tileIndex]), [counter](const gridTile* t) { counter->fetch_sub(1); delete t; });
+		pendingOwnsTile[tileIndex] = true;
+	}
+
+	// Only the writer holds a mutable view of pending tiles, readers never see them before publish
+	gridTile* tile = const_cast<gridTile*>(pending->tiles[tileIndex].get());
+	uint64_t mask = uint64_t(1) << (x % SNAPSHOT_TILE_SIZE);
+	if (blocked)
+		tile->rows[y % SNAPSHOT_TILE_SIZE] |= mask;
+	else
+		tile->rows[y % SNAPSHOT_TILE_SIZE] &= ~mask;
+}
+
+bool
+versionedGrid::isBlocked(int x, int y) const
+{
+	return pending != nullptr ? pending->isBlocked(x, y) : current.load()->isBlocked(x, y);
+}
+
+void
+versionedGrid::publish()
+{
+	if (pending == nullptr)
+		return;
+
+	gridVersion* old = current.exchange(pending);
+	pending = nullptr;
+
+	// Readers that announce a later epoch are guaranteed to see the new version
+	old->retiredEpoch = epoch.fetch_add(1);
+	retired.push_back(old);
+
+	reclaim();
+}
+
+void
+versionedGrid::reclaim()
+{
+	uint64_t oldestPinned = UINT64_MAX;
+	for (int i = 0; i < readerCount; i++)
+	{
+		uint64_t e = readers[i].epoch.load();
+		if (e != 0)
+			oldestPinned = std::min(oldestPinned, e);
+	}
+
+	// A reader that pinned in epoch e may hold any version retired in e or later
+	auto stillPinned = std::partition(retired.begin(), retired.end(), [oldestPinned](const gridVersion* v) { return v->retiredEpoch >= oldestPinned; });
+	for (auto it = stillPinned; it != retired.end(); it++)
+		delete *it;
+	retired.erase(stillPinned, retired.end());
+}
+
+unsigned long long
+versionedGrid::getVersionNumber() const
+{
+	return current.load()->number;
+}
+
+long
+versionedGrid::getLiveTileCount() const
+{
+	return liveTiles->load();
+}
+
+size_t
+versionedGrid::getRetiredCount() const
+{
+	return retired.size();
+}
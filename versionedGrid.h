@@ -0,0 +1,121 @@
+#pragma once
+
+/*
+	Versioned, copy-on-write passability for searching while the map is being edited
+
+	The map is split into SNAPSHOT_TILE_SIZE x SNAPSHOT_TILE_SIZE tiles and a version is just a table of pointers to
+	immutable tiles. Editing copies only the tiles it touches into the next version, every other tile is shared, so
+	memory grows with the number of modified tiles rather than with the number of versions.
+
+	Readers pin the newest version and can keep using it for as long as a search takes, no matter what the editor does
+	in the meantime. Publishing never waits on readers: old versions are retired with the epoch they were replaced in
+	and only freed once every reader has moved past that epoch ( epoch based reclamation ).
+
+	There is one writer, and up to as many readers as the slot count given to the constructor. A reader takes a slot of
+	its own with acquireReader before it pins anything and hands it back with releaseReader, so two threads can never
+	end up sharing one. The writer side also answers isBlocked for the newest state, edits not yet published included,
+	which makes the versioned grid the only copy of the passability its owner needs to keep.
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// One 64-bit word per tile row
+#define SNAPSHOT_TILE_SIZE 64
+
+struct gridTile {
+	// A set bit means the cell is blocked
+	uint64_t rows[SNAPSHOT_TILE_SIZE] = {};
+};
+
+class gridVersion {
+	friend class versionedGrid;
+
+/// Variables
+private:
+	int width, height;
+	int tilesX, tilesY;
+
+	unsigned long long number = 0;
+	std::vector<std::shared_ptr<const gridTile>> tiles;
+
+	// Epoch this version was replaced in, only meaningful once it has been retired
+	uint64_t retiredEpoch = 0;
+
+/// Functions & Methods
+public:
+	// Getters, anything outside of the map counts as blocked
+	bool isBlocked(int x, int y) const;
+	unsigned long long getNumber() const;
+	int getWidth() const;
+	int getHeight() const;
+
+	// Same layout as passabilityBitmap::neighbourMask, bit i set when the i-th neighbour ( NW, N, NE, W, E, SW, S, SE ) is passable
+	unsigned int neighbourMask(int x, int y) const;
+
+private:
+	gridVersion(int width, int height);
+
+	// Returns the blocked bits of x - 1, x and x + 1 in row y
+	unsigned int readThree(int x, int y) const;
+};
+
+class versionedGrid {
+/// Variables
+private:
+	struct readerSlot {
+		// 0 while the reader has nothing pinned, otherwise the epoch it pinned in
+		std::atomic<uint64_t> epoch{ 0 };
+
+		// Set while a reader owns the slot
+		std::atomic<bool> taken{ false };
+
+		// Keeps every slot on its own cache line
+		char padding[64 - sizeof(std::atomic<uint64_t>) - sizeof(std::atomic<bool>)];
+	};
+
+	int width, height;
+
+	std::atomic<gridVersion*> current;
+	std::atomic<uint64_t> epoch{ 1 };
+	std::unique_ptr<readerSlot[]> readers;
+	int readerCount;
+
+	// Writer side state, only ever touched by the editing thread
+	gridVersion* pending = nullptr;
+	std::vector<bool> pendingOwnsTile;
+	std::vector<gridVersion*> retired;
+	std::shared_ptr<std::atomic<long>> liveTiles;
+
+/// Functions & Methods
+public:
+	// Constructor & Deconstructor, every cell starts out passable
+	versionedGrid(int width, int height, int readerCount);
+	~versionedGrid();
+
+	// Reader side, every reading thread takes a slot of its own and passes it to pin and unpin
+	// acquireReader returns -1 when every slot is taken
+	int acquireReader();
+	void releaseReader(int reader);
+
+	// The returned version stays valid and unchanged until the same reader calls unpin
+	const gridVersion* pin(int reader);
+	void unpin(int reader);
+
+	// Writer side, edits are collected until publish makes them visible to readers that pin afterwards
+	void setBlocked(int x, int y, bool blocked);
+	void publish();
+
+	// Newest state of a cell as the writer sees it, edits that haven't been published yet included
+	bool isBlocked(int x, int y) const;
+
+	// Frees retired versions no reader can still be using, publish already does this
+	void reclaim();
+
+	// Getters
+	unsigned long long getVersionNumber() const;
+	long getLiveTileCount() const;
+	size_t getRetiredCount() const;
+};